@@ -0,0 +1,346 @@
+/* bench.c --- benchmarks for the 16candles debugger engine.
+   Copyright (c) 2014 Joe Jevnik
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 2 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 51
+   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA. */
+
+#include "debug.h"
+#include "util.h"
+
+// The format version of the report, bump it when a field changes meaning.
+#define BENCH_FORMAT 1
+
+// The defaults for the number of samples and the ticks in each sample.
+#define BENCH_SAMPLES 31
+#define BENCH_TICKS   20000
+
+// Where the programs' stack starts, well clear of their code.
+#define BENCH_STACK 0x8000
+
+// The io program is fed input every this many ticks, which is fewer than
+// the reads that would empty the input buffer.
+#define BENCH_FEED 64
+
+// The kinds of synthetic programs.
+typedef enum{
+    GEN_ARITH, // Loops over the binary operators.
+    GEN_STACK, // Pushes and pops.
+    GEN_MSET,  // Writes to memory.
+    GEN_IO,    // Reads and writes.
+    GEN_COUNT,
+}gen_kind;
+
+static const char* const gen_strs[GEN_COUNT] = { "arith","stack","mset","io" };
+
+// A program being generated.
+typedef struct{
+    c16_halfword code[0x1000];
+    size_t       len;
+}gen_buf;
+
+// The report is written here; stdout is sent to /dev/null while measuring.
+static FILE *report;
+
+// Appends a byte to the program.
+static void emit(gen_buf *b,c16_halfword v){
+    b->code[b->len++] = v;
+}
+
+// Appends a big endian word to the program.
+static void emit_word(gen_buf *b,c16_word v){
+    emit(b,v >> 8);
+    emit(b,v & 0xff);
+}
+
+// Emits `op a b dest` for a binary operator with a register and a literal.
+static void emit_reg_lit(gen_buf *b,c16_opcode op,c16_halfword a,c16_word l,
+                         c16_halfword dest){
+    emit(b,op);
+    emit(b,a);
+    emit_word(b,l);
+    emit(b,dest);
+}
+
+// Emits `op a b dest` for a binary operator with two registers.
+static void emit_reg_reg(gen_buf *b,c16_opcode op,c16_halfword a,
+                         c16_halfword c,c16_halfword dest){
+    emit(b,op);
+    emit(b,a);
+    emit(b,c);
+    emit(b,dest);
+}
+
+// Generates a program of the given kind that never terminates: a body of
+// the workload's operations repeated in a counted loop that starts over.
+static void gen_program(gen_buf *b,gen_kind k){
+    c16_word loop;
+    int      n;
+    b->len = 0;
+    emit(b,OP_SET_LIT);                        // spt = BENCH_STACK
+    emit_word(b,BENCH_STACK);
+    emit(b,OP_spt);
+    emit(b,OP_ADD_LIT_LIT);                    // r0 = 64
+    emit_word(b,0);
+    emit_word(b,64);
+    emit(b,OP_r0);
+    loop = (c16_word) b->len;
+    for (n = 0;n < 4;n++){
+        switch(k){
+        case GEN_ARITH:
+            emit_reg_lit(b,OP_ADD_REG_LIT,OP_r1,3,OP_r1);
+            emit_reg_reg(b,OP_MUL_REG_REG,OP_r1,OP_r2,OP_r2);
+            emit_reg_reg(b,OP_XOR_REG_REG,OP_r2,OP_r1,OP_r3);
+            emit_reg_lit(b,OP_SUB_REG_LIT,OP_r3,1,OP_r4);
+            break;
+        case GEN_STACK:
+            emit(b,OP_PUSH_ + REG);
+            emit(b,OP_r1);
+            emit(b,OP_PUSH_ + REG);
+            emit(b,OP_r2);
+            emit(b,OP_POP);
+            emit(b,OP_r3);
+            emit(b,OP_POP);
+            emit(b,OP_r4);
+            break;
+        case GEN_MSET:
+            emit(b,OP_MSET_REG_MEMADDR);
+            emit(b,OP_r1);
+            emit_word(b,0x8000 + n * 2);
+            emit_reg_lit(b,OP_ADD_REG_LIT,OP_r1,1,OP_r1);
+            break;
+        case GEN_IO:
+            emit(b,OP_READ);
+            emit(b,OP_r1);
+            emit(b,OP_WRITE_REG);
+            emit(b,OP_r0_b);
+            break;
+        default:
+            break;
+        }
+    }
+    emit_reg_lit(b,OP_SUB_REG_LIT,OP_r0,1,OP_r0);
+    emit(b,OP_GT_REG_LIT);
+    emit(b,OP_r0);
+    emit_word(b,0);
+    emit(b,OP_JMPT);
+    emit_word(b,loop);
+    emit(b,OP_JMP);
+    emit_word(b,0);
+}
+
+// Orders samples for qsort.
+static int dbl_cmp(const void *a,const void *b){
+    double d = *(const double*) a - *(const double*) b;
+    return (d > 0) - (d < 0);
+}
+
+// Returns the pth percentile of the sorted samples.
+static double pct(const double *s,size_t n,double p){
+    return s[(size_t) (p * (n - 1) / 100.0 + 0.5)];
+}
+
+// Prints one result as a line of json.
+static void report_line(const char *name,const char *unit,double *s,size_t n){
+    qsort(s,n,sizeof(double),dbl_cmp);
+    fprintf(report,"{\"format\":%d,\"bench\":\"%s\",\"unit\":\"%s\","
+            "\"samples\":%zu,\"min\":%.1f,\"p50\":%.1f,\"p90\":%.1f,"
+            "\"p99\":%.1f,\"max\":%.1f}\n",
+            BENCH_FORMAT,name,unit,n,s[0],pct(s,n,50),pct(s,n,90),
+            pct(s,n,99),s[n - 1]);
+    fflush(report);
+}
+
+// Writes a generated program to a temporary file and loads it as the binary.
+// return: false if the file could not be written.
+static bool load_program(gen_buf *b){
+    static char fl[] = "/tmp/16cdb-bench-XXXXXX";
+    int   fd;
+    FILE *in;
+    if (binary_fl){
+        unlink(binary_fl);
+    }
+    strcpy(fl + sizeof(fl) - 7,"XXXXXX");
+    if ((fd = mkstemp(fl)) == -1 || !(in = fdopen(fd,"w+"))){
+        perror("16cdb-bench");
+        return false;
+    }
+    fwrite(b->code,1,b->len,in);
+    fclose(in);
+    binary_fl = fl;
+    return restart_vm();
+}
+
+// Tops the vm's input buffer back up to full.
+static void feed_input(void){
+    while (*sysmem.inputc < 256){
+        push_input('x');
+    }
+}
+
+// Measures the ticks per second of proc_tick on the program. The io
+// program's reads are kept fed, and the feeding is part of what is timed,
+// so every read finds a byte as it would for a program being typed at.
+static void bench_ticks(gen_kind k,size_t samples,size_t ticks){
+    char    name[32];
+    double *s = malloc(samples * sizeof(double));
+    double  t;
+    size_t  n,m;
+    if (sigsetjmp(jump,1)){
+        fprintf(stderr,"16cdb-bench: the %s program crashed\n",gen_strs[k]);
+        exit(-1);
+    }
+    for (n = 0;n < samples;n++){
+        t = now_ns();
+        for (m = 0;m < ticks;m++){
+            if (k == GEN_IO && m % BENCH_FEED == 0){
+                feed_input();
+            }
+            proc_tick();
+        }
+        s[n] = ticks * 1e9 / (now_ns() - t);
+    }
+    snprintf(name,sizeof(name),"tick.%s",gen_strs[k]);
+    report_line(name,"ticks/s",s,samples);
+    free(s);
+}
+
+// Measures the latency of a `step` through eval_line.
+static void bench_step(size_t samples){
+    char    line[8];
+    double *s = malloc(samples * sizeof(double));
+    double  t;
+    size_t  n;
+    for (n = 0;n < samples;n++){
+        strcpy(line,"step");
+        t = now_ns();
+        eval_line(line);
+        s[n] = now_ns() - t;
+    }
+    report_line("cmd.step","ns",s,samples);
+    free(s);
+}
+
+// Measures the latency of restarting the vm.
+static void bench_restart(size_t samples){
+    double *s = malloc(samples * sizeof(double));
+    double  t;
+    size_t  n;
+    for (n = 0;n < samples;n++){
+        t = now_ns();
+        restart_vm();
+        s[n] = now_ns() - t;
+    }
+    report_line("cmd.restart","ns",s,samples);
+    free(s);
+}
+
+// Measures the throughput of printing all of memory a word at a time.
+static void bench_memdump(size_t samples){
+    double  *s = malloc(samples * sizeof(double));
+    double   t;
+    size_t   n;
+    uint32_t a;
+    for (n = 0;n < samples;n++){
+        t = now_ns();
+        for (a = 0;a < C16_ADDR_SPACE;a += 2){
+            print_memaddr((c16_word) a,false);
+        }
+        fflush(stdout);
+        s[n] = C16_ADDR_SPACE * 1e9 / (now_ns() - t) / (1 << 20);
+    }
+    report_line("mem.dump","MiB/s",s,samples);
+    free(s);
+}
+
+const char* const bench_usage_str = "Usage: 16cdb-bench [OPTION]";
+
+const char* const bench_help_str = "\
+  -h --help               Prints the help message.\n\
+  -s --samples N          The number of samples per benchmark.\n\
+  -t --ticks N            The number of ticks in each tick sample.\n\
+  -e --emit KIND FILE     Writes the generated KIND program to FILE and exits,\n\
+                          KIND is one of arith, stack, mset, or io.\n\
+Each result is printed as one line of json with percentiles of the samples.";
+
+int main(int argc,char **argv){
+    gen_buf  b;
+    FILE    *out;
+    int      c,k,opt_ind;
+    size_t   samples = BENCH_SAMPLES,ticks = BENCH_TICKS;
+    static struct option long_ops[] =
+        { { "help",    no_argument,       0, 'h' },
+          { "samples", required_argument, 0, 's' },
+          { "ticks",   required_argument, 0, 't' },
+          { "emit",    required_argument, 0, 'e' },
+          { 0,         0,                 0,  0  } };
+    for (;;){
+        opt_ind = 0;
+        c = getopt_long(argc,argv,"hs:t:e:",long_ops,&opt_ind);
+        if (c == -1){
+            break;
+        }
+        switch(c){
+        case 'h':
+            puts(bench_usage_str);
+            puts(bench_help_str);
+            return 0;
+        case 's':
+            samples = strtoul(optarg,NULL,0);
+            break;
+        case 't':
+            ticks = strtoul(optarg,NULL,0);
+            break;
+        case 'e':
+            for (k = 0;k < GEN_COUNT && strcmp(optarg,gen_strs[k]);k++);
+            if (k == GEN_COUNT || optind >= argc){
+                puts(bench_usage_str);
+                return -1;
+            }
+            gen_program(&b,(gen_kind) k);
+            if (!(out = fopen(argv[optind],"w"))){
+                fprintf(stderr,"Error: Unable to open file '%s'\n",
+                        argv[optind]);
+                return -1;
+            }
+            fwrite(b.code,1,b.len,out);
+            fclose(out);
+            return 0;
+        case '?':
+            return -1;
+        }
+    }
+    if (!samples || !ticks){
+        puts(bench_usage_str);
+        return -1;
+    }
+    report = fdopen(dup(STDOUT_FILENO),"w");
+    freopen("/dev/null","w",stdout);
+    pipe(pipe_fds);
+    signal(SIGSEGV,sigsegv_handler);
+    if (!init_vm(tmpfile(),MEM_ANON,NULL,false)){
+        return -1;
+    }
+    for (k = 0;k < GEN_COUNT;k++){
+        gen_program(&b,(gen_kind) k);
+        if (!load_program(&b)){
+            return -1;
+        }
+        bench_ticks((gen_kind) k,samples,ticks);
+    }
+    bench_step(samples * 100);
+    bench_restart(samples);
+    bench_memdump(samples);
+    unlink(binary_fl);
+    return EXIT_SUCCESS;
+}
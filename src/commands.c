@@ -29,6 +29,12 @@ char     *binary_fl;
 // The stdin thread, used to mimic the stdin features on the machine.
 pthread_t input_thread;
 
+// The breakpoints, indexed by address.
+bool breakpoints[C16_ADDR_SPACE];
+
+// The registers at the last stop, which `dump` and the deltas compare to.
+c16_regfile stop_regs;
+
 // The names of all the registers.
 static char *reg_strs[] = { "ipt",
                             "spt",
@@ -71,66 +77,199 @@ static char *reg_strs[] = { "ipt",
 
 // Terminates the program.
 void cmd_quit(char **_){
-    pthread_cancel(input_thread);
-    free_regs();
-    free_mem(&sysmem);
+    stop_input();
+    free_vmem(&sysmem,&sysvmem);
     exit(0);
 }
 
-// Restarts the vm.
-void cmd_restart(char **_){
+// Reloads the binary, resets the registers and restarts the input thread.
+// return: false if the binary could not be opened.
+bool restart_vm(void){
     FILE *in;
-    void repl(void);
     void init_regs(void);
-    pthread_cancel(input_thread);
-    free_regs();
+    stop_input();
     init_regs();
     in = fopen(binary_fl,"r");
     if (!in){
         fprintf(stderr,"Error: Unable to open file '%s'\n",binary_fl);
-        exit(-1);
+        return false;
     }
     load_file(&sysmem,0,in);
-    repl();
+    fclose(in);
+    stop_regs = regfile;
+    heat_reset();
+    rewind_input();
+    start_input();
+    if (verifying){
+        verify_sync();
+    }
+    return true;
+}
+
+// Restarts the vm.
+void cmd_restart(char **_){
+    if (!restart_vm()){
+        exit(-1);
+    }
+}
+
+// Checks if a register has changed since the last stop.
+static inline bool reg_changed(c16_halfword n){
+    return *(c16_word*) reg_in(&regfile,n)
+        != *(c16_word*) reg_in(&stop_regs,n);
+}
+
+// Prints the registers that changed since the last stop on one line.
+static void print_delta(void){
+    const char  *sep = "changed: ";
+    c16_halfword n;
+    if (!memcmp(&regfile,&stop_regs,sizeof(c16_regfile))){
+        return;
+    }
+    for (n = 0;n < HALFREG_START;n++){
+        if (reg_changed(n)){
+            printf("%s%s 0x%04x -> 0x%04x",sep,reg_strs[n],
+                   *(c16_word*) reg_in(&stop_regs,n),
+                   *(c16_word*) reg_in(&regfile,n));
+            sep = ", ";
+        }
+    }
+    putchar('\n');
 }
 
-// Prints the state of the machines registers to stdout.
+// Prints the state of the machines registers to stdout, marking the ones
+// that changed since the last stop with a `*`.
 void cmd_dump(char **_){
-    printf(
-        "ipt: 0x%04x\n"
-        "spt: 0x%04x\n"
-        "ac1: 0x%04x\n"
-        "ac2: 0x%04x\n"
-        "tst: 0x%04x\n"
-        "inp: 0x%04x: inp_w: 0x%02x, inp_r: 0x%02x\n"
-        "r0:  0x%04x: r0_f:  0x%02x, r0_b:  0x%02x\n"
-        "r1:  0x%04x: r1_f:  0x%02x, r1_b:  0x%02x\n"
-        "r2:  0x%04x: r2_f:  0x%02x, r2_b:  0x%02x\n"
-        "r3:  0x%04x: r3_f:  0x%02x, r3_b:  0x%02x\n"
-        "r4:  0x%04x: r4_f:  0x%02x, r4_b:  0x%02x\n"
-        "r5:  0x%04x: r5_f:  0x%02x, r5_b:  0x%02x\n"
-        "r6:  0x%04x: r6_f:  0x%02x, r6_b:  0x%02x\n"
-        "r7:  0x%04x: r7_f:  0x%02x, r7_b:  0x%02x\n"
-        "r8:  0x%04x: r8_f:  0x%02x, r8_b:  0x%02x\n"
-        "r9:  0x%04x: r9_f:  0x%02x, r9_b:  0x%02x\n",
-        *ipt,*spt,*ac1,*ac2,*tst,*inp,*inp_w,*inp_r,
-        *r0,*r0_f,*r0_b,*r1,*r1_f,*r1_b,*r2,*r2_f,*r2_b,*r3,*r3_f,*r3_b,
-        *r4,*r4_f,*r4_b,*r5,*r5_f,*r5_b,*r6,*r6_f,*r6_b,*r7,*r7_f,*r7_b,
-        *r8,*r8_f,*r8_b,*r9,*r9_f,*r9_b);
+    static const c16_halfword halves[][2] = { { OP_inp_w,OP_inp_r },
+                                              { OP_r0_f, OP_r0_b  },
+                                              { OP_r1_f, OP_r1_b  },
+                                              { OP_r2_f, OP_r2_b  },
+                                              { OP_r3_f, OP_r3_b  },
+                                              { OP_r4_f, OP_r4_b  },
+                                              { OP_r5_f, OP_r5_b  },
+                                              { OP_r6_f, OP_r6_b  },
+                                              { OP_r7_f, OP_r7_b  },
+                                              { OP_r8_f, OP_r8_b  },
+                                              { OP_r9_f, OP_r9_b  } };
+    const c16_halfword *h;
+    c16_halfword        n;
+    for (n = 0;n < HALFREG_START;n++){
+        printf("%s:%-*s0x%04x",reg_strs[n],4 - (int) strlen(reg_strs[n]),"",
+               *(c16_word*) reg_in(&regfile,n));
+        if (n >= OP_inp){
+            h = halves[n - OP_inp];
+            printf(": %s:%-*s0x%02x, %s:%-*s0x%02x",
+                   reg_strs[h[0]],6 - (int) strlen(reg_strs[h[0]]),"",
+                   *(c16_halfword*) reg_in(&regfile,h[0]),
+                   reg_strs[h[1]],6 - (int) strlen(reg_strs[h[1]]),"",
+                   *(c16_halfword*) reg_in(&regfile,h[1]));
+        }
+        puts((reg_changed(n)) ? " *" : "");
+    }
 }
 
 // Step the program through a single operation.
 void cmd_step(char **_){
+    stop_regs = regfile;
     if (sigsetjmp(jump,1) == 0){
-        if (proc_tick()){
+        if (vm_tick() == -1){
             puts("Read `term`, exited succesfully");
         }
     }
+    print_delta();
+}
+
+// Checks for a breakpoint at the ipt.
+static inline bool at_breakpoint(void){
+    uint64_t t = stat_begin(STAT_BREAK);
+    bool     b = breakpoints[*ipt];
+    stat_end(STAT_BREAK,t);
+    return b;
+}
+
+// Runs until a breakpoint or the end of the program.
+void cmd_continue(char **_){
+    const char *l;
+    int         r;
+    stop_regs = regfile;
+    if (sigsetjmp(jump,1) == 0){
+        while (!(r = vm_tick()) && !at_breakpoint());
+        if (r == -1){
+            puts("Read `term`, exited succesfully");
+        }else if (!r){
+            l = symstr(*ipt);
+            printf("breakpoint: 0x%04x%s%s\n",*ipt,(l) ? " " : "",
+                   (l) ? l : "");
+        }
+    }
+    print_delta();
+}
+
+// Runs one tick of a paced run.
+// return: 0, or the reason to stop plus one.
+static int run_tick(void){
+    int r = vm_tick();
+    if (r == -1){
+        return PACE_TERM + 1;
+    }else if (r){
+        return PACE_DIVERGED + 1;
+    }
+    return (at_breakpoint()) ? PACE_BREAKPOINT + 1 : 0;
+}
+
+// Runs at a fixed number of ticks per second until a breakpoint, the end of
+// the program, or ^C, then prints the rate that was achieved.
+void cmd_run(char **argv){
+    c16_pace    p;
+    const char *l;
+    char       *end;
+    double      hz = strtod(argv[0],&end);
+    if (*end || !(hz > 0) || hz > 1e9){
+        printf("error: '%s': not a rate in ticks per second\n",argv[0]);
+        return;
+    }
+    stop_regs = regfile;
+    switch(pace_run(hz,run_tick,&p)){
+    case PACE_TERM:
+        puts("Read `term`, exited succesfully");
+        break;
+    case PACE_BREAKPOINT:
+        l = symstr(*ipt);
+        printf("breakpoint: 0x%04x%s%s\n",*ipt,(l) ? " " : "",(l) ? l : "");
+        break;
+    case PACE_INTERRUPT:
+        puts("interrupted");
+        break;
+    default:
+        break;
+    }
+    pace_print(stdout,&p);
+    print_delta();
+}
+
+// Sets a breakpoint at an address or label.
+void cmd_break(char **argv){
+    c16_word a;
+    if (parse_addr(argv[0],&a)){
+        breakpoints[a] = true;
+    }
+}
+
+// Removes the breakpoint at an address or label.
+void cmd_clear(char **argv){
+    c16_word a;
+    if (parse_addr(argv[0],&a)){
+        breakpoints[a] = false;
+    }
 }
 
 // Feeds input into the machine's standard in.
 void cmd_inp(char **argv){
     char *esc;
+    if (input_mode == INPUT_REPLAY){
+        puts("error: the input is being replayed");
+        return;
+    }
     esc = escapestr(argv[0]);
     if (!esc){
         return;
@@ -180,6 +319,27 @@ char *escapestr(char *src){
     return dest;
 }
 
+// Parses a memory address or label out of the string.
+// return: false if it is neither, after printing an error.
+bool parse_addr(char *s,c16_word *a){
+    char *e;
+    long  l;
+    if (sym_lookup(&symtab,s,a)){
+        return true;
+    }
+    l = strtol(s,&e,0);
+    if (*e != '\0'){
+        printf("memory address: '%s': does not  exist\n",s);
+        return false;
+    }
+    if (l < 0 || l > 0xffff){
+        printf("memory address: 0x%x: is out of bounds\n",l);
+        return false;
+    }
+    *a = (c16_word) l;
+    return true;
+}
+
 // Parses the register number out of the string.
 // return: the number, or REG_DNE if it does not exist.
 c16_halfword parse_regno(char *s){
@@ -209,9 +369,8 @@ void cmd_reg(char **argv){
 
 // Parses the memaddr commands paramaters.
 void cmd_mem(char **argv){
-    char        *e;
     bool         b;
-    long         l;
+    c16_word     a;
     c16_halfword r;
     if (!strcmp(argv[0],"w")){
         b = false;
@@ -225,16 +384,10 @@ void cmd_mem(char **argv){
         print_memreg(argv[1],b);
         return;
     }
-    l = strtol(argv[1],&e,0);
-    if (!l && *e != '\0'){
-        printf("memory address: '%s': does not  exist\n",argv[1]);
+    if (!parse_addr(argv[1],&a)){
         return;
     }
-    if (l < 0 || l > 0xffff){
-        printf("memory address: 0x%x: is out of bounds\n",l);
-        return;
-    }
-    print_memaddr((c16_word) l,b);
+    print_memaddr(a,b);
     return;
 }
 
@@ -270,3 +423,54 @@ void cmd_help(char **_){
         printf("  %s\n",commands[n].help);
     }
 }
+
+// Prints the counters as a table or as json, or resets them.
+void cmd_stats(char **argv){
+    if (!strcmp(argv[0],"table")){
+        stats_print(stdout,false);
+    }else if (!strcmp(argv[0],"json")){
+        stats_print(stdout,true);
+    }else if (!strcmp(argv[0],"reset")){
+        stats_reset();
+    }else{
+        puts("Usage: stats table|json|reset");
+    }
+}
+
+// Prints the disassembly of the binary, marking what was never executed.
+// The binary is read again rather than taken from memory, which the
+// program may have written over.
+void cmd_coverage(char **_){
+    static c16_halfword code[C16_ADDR_SPACE];
+    FILE               *in = fopen(binary_fl,"r");
+    size_t              len;
+    if (!in){
+        fprintf(stderr,"Error: Unable to open file '%s'\n",binary_fl);
+        return;
+    }
+    len = fread(code,1,sizeof(code),in);
+    fclose(in);
+    cov_report(stdout,&coverage,code,len);
+}
+
+// Saves the session to a file that `16cdb --resume` can start from.
+void cmd_save(char **argv){
+    if (save_snapshot(argv[0])){
+        printf("saved: %s\n",argv[0]);
+    }
+}
+
+// Prints, resets, or turns on or off the data access counters.
+void cmd_heatmap(char **argv){
+    if (!strcmp(argv[0],"show")){
+        heat_print(stdout);
+    }else if (!strcmp(argv[0],"on")){
+        heat_on = true;
+    }else if (!strcmp(argv[0],"off")){
+        heat_on = false;
+    }else if (!strcmp(argv[0],"reset")){
+        heat_reset();
+    }else{
+        puts("Usage: heatmap show|on|off|reset");
+    }
+}
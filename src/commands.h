@@ -22,6 +22,16 @@
 #include "../16machine/machine/memory.h"
 #include "../16machine/machine/processor.h"
 #include "../16machine/machine/register.h"
+#include "coverage.h"
+#include "heatmap.h"
+#include "pace.h"
+#include "regfile.h"
+#include "replay.h"
+#include "snapshot.h"
+#include "verify.h"
+#include "stats.h"
+#include "symbols.h"
+#include "vmem.h"
 
 #include <stdbool.h>
 #include <errno.h>
@@ -34,15 +44,15 @@
 #include <readline/readline.h>
 #include <readline/history.h>
 
-// The constant for register does not exist.
-#define REG_DNE 38
-
-// The index where halfregs start.
-#define HALFREG_START 16
-
 extern jmp_buf jump;
 extern char   *binary_fl;
 
+// The breakpoints, indexed by address.
+extern bool breakpoints[C16_ADDR_SPACE];
+
+// The registers at the last stop, which `dump` and the deltas compare to.
+extern c16_regfile stop_regs;
+
 typedef void cmd_func(char**);
 
 typedef struct {
@@ -52,7 +62,7 @@ typedef struct {
     char     *help; // The help string.
 } command;
 
-#define COMMAND_COUNT 12
+#define COMMAND_COUNT 21
 
 // The list of commands.
 command commands[COMMAND_COUNT];
@@ -64,18 +74,46 @@ command *resolve_cmd(char*);
 // Exits the program.
 void cmd_quit(char**);
 
+// Reloads the binary, resets the registers and restarts the input thread.
+// return: false if the binary could not be opened.
+bool restart_vm(void);
+
 // Restarts the vm.
 void cmd_restart(char**);
 
 // Steps through one operation.
 void cmd_step(char**);
 
+// Runs until a breakpoint or the end of the program.
+void cmd_continue(char**);
+
+// Sets a breakpoint.
+void cmd_break(char**);
+
+// Removes a breakpoint.
+void cmd_clear(char**);
+
 // Prints the state of the machines registers to stdout.
 void cmd_dump(char**);
 
 // Prints the help message.
 void cmd_help(char**);
 
+// Prints the coverage report for the binary.
+void cmd_coverage(char**);
+
+// Saves the session to a file that `16cdb --resume` can start from.
+void cmd_save(char**);
+
+// Runs at a fixed number of ticks per second.
+void cmd_run(char**);
+
+// Prints, resets, or turns on or off the data access counters.
+void cmd_heatmap(char**);
+
+// Prints or resets the counters of the debugger's internals.
+void cmd_stats(char**);
+
 // Feeds input into the machine's standard in.
 void cmd_inp(char**);
 
@@ -97,11 +135,12 @@ void print_memreg(char*,bool);
 // malloc's a string, be sure to free it.
 char *escapestr(char*);
 
+// Parses a memory address or label out of the string.
+// return: false if it is neither, after printing an error.
+bool parse_addr(char*,c16_word*);
+
 // Parses the register number out of the string.
 // return: the number, or REG_DNE if it does not exist.
 c16_halfword parse_regno(char*);
 
-// Frees the registers.
-void free_regs();
-
 #endif
@@ -0,0 +1,114 @@
+/* coverage.c --- code coverage for the 16candles debugger.
+   Copyright (c) 2014 Joe Jevnik
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 2 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 51
+   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA. */
+
+#include "coverage.h"
+#include "debug.h"
+
+#include <string.h>
+
+// The coverage of the running program.
+c16_coverage coverage;
+
+// Ors the src coverage into dest.
+void cov_merge(c16_coverage *dest,const c16_coverage *src){
+    size_t n;
+    for (n = 0;n < COV_BITMAP_SIZE;n++){
+        dest->exec[n]   |= src->exec[n];
+        dest->taken[n]  |= src->taken[n];
+        dest->fallen[n] |= src->fallen[n];
+    }
+}
+
+// Reads a coverage file.
+// return: false if the file does not exist or is not a coverage file.
+bool cov_read(const char *fl,c16_coverage *cov){
+    FILE    *in;
+    char     magic[sizeof(COV_MAGIC) - 1];
+    uint8_t  v[4];
+    bool     ok;
+    if (!(in = fopen(fl,"rb"))){
+        return false;
+    }
+    ok = fread(magic,sizeof(magic),1,in) == 1
+        && !memcmp(magic,COV_MAGIC,sizeof(magic))
+        && fread(v,sizeof(v),1,in) == 1
+        && (v[0] | v[1] << 8 | v[2] << 16 | (uint32_t) v[3] << 24)
+           == COV_VERSION
+        && fread(cov,sizeof(c16_coverage),1,in) == 1;
+    fclose(in);
+    return ok;
+}
+
+// Writes a coverage file.
+// return: false if the file could not be written.
+bool cov_write(const char *fl,const c16_coverage *cov){
+    FILE    *out;
+    uint8_t  v[4] = { COV_VERSION & 0xff,0,0,0 };
+    bool     ok;
+    if (!(out = fopen(fl,"wb"))){
+        return false;
+    }
+    ok = fwrite(COV_MAGIC,sizeof(COV_MAGIC) - 1,1,out) == 1
+        && fwrite(v,sizeof(v),1,out) == 1
+        && fwrite(cov,sizeof(c16_coverage),1,out) == 1;
+    return !fclose(out) && ok;
+}
+
+// Merges the running program's coverage into the file, creating it if
+// needed.
+// return: false if the file could not be read or written.
+bool cov_save(const char *fl){
+    c16_coverage old;
+    if (!access(fl,F_OK) && !cov_read(fl,&old)){
+        fprintf(stderr,"Error: '%s' is not a coverage file\n",fl);
+        return false;
+    }else if (!access(fl,F_OK)){
+        cov_merge(&old,&coverage);
+        return cov_write(fl,&old);
+    }
+    return cov_write(fl,&coverage);
+}
+
+// Prints the disassembly of the len bytes of code, marking the instructions
+// that were never executed and the directions each jump has gone.
+void cov_report(FILE *out,const c16_coverage *cov,const c16_halfword *code,
+                size_t len){
+    size_t         a,execc = 0,instc = 0;
+    const c16_sym *s;
+    c16_halfword   op;
+    bool           e,t,f;
+    for (a = 0;a < len;a += oplen(op)){
+        op = code[a];
+        e  = cov_test(cov->exec,a);
+        if ((s = sym_at(&symtab,a)) && s->addr == a){
+            fprintf(out,"%s:\n",s->name);
+        }
+        fprintf(out,"%s 0x%04zx  %-6s",(e) ? "     " : "#####",a,
+                cmdstr(op,false));
+        if (op == OP_JMPT || op == OP_JMPF){
+            t = cov_test(cov->taken,a);
+            f = cov_test(cov->fallen,a);
+            fprintf(out,"  [%s]",(t && f) ? "both ways"
+                    : (t) ? "never fell through"
+                    : (f) ? "never taken" : "never reached");
+        }
+        fputc('\n',out);
+        ++instc;
+        execc += e;
+    }
+    fprintf(out,"%zu of %zu instructions executed\n",execc,instc);
+}
@@ -0,0 +1,83 @@
+/* coverage.h --- code coverage for the 16candles debugger.
+   Copyright (c) 2014 Joe Jevnik
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 2 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 51
+   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA. */
+
+#ifndef C16_DEBUG_COVERAGE_H
+#define C16_DEBUG_COVERAGE_H
+
+#include "../16common/common/arch.h"
+#include "symbols.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// The magic number and version at the start of a coverage file.
+#define COV_MAGIC   "16CDBCOV"
+#define COV_VERSION 1
+
+// The number of bytes in one bitmap, one bit per address.
+#define COV_BITMAP_SIZE (C16_ADDR_SPACE / 8)
+
+// The coverage of a program, as bitmaps indexed by address.
+// A coverage file is COV_MAGIC, then COV_VERSION as a little endian 32 bit
+// int, then the three bitmaps in order; files are merged with bitwise or.
+typedef struct{
+    uint8_t exec[COV_BITMAP_SIZE];   // Instructions that were executed.
+    uint8_t taken[COV_BITMAP_SIZE];  // Conditional jumps that were taken.
+    uint8_t fallen[COV_BITMAP_SIZE]; // Conditional jumps that fell through.
+}c16_coverage;
+
+// The coverage of the running program.
+extern c16_coverage coverage;
+
+// Marks the instruction at the address as executed.
+static inline void cov_exec(c16_word a){
+    coverage.exec[a >> 3] |= 1 << (a & 7);
+}
+
+// Marks the direction that the conditional jump at the address went.
+static inline void cov_branch(c16_word a,bool taken){
+    uint8_t *b = (taken) ? coverage.taken : coverage.fallen;
+    b[a >> 3] |= 1 << (a & 7);
+}
+
+// Tests the bit for the address in a bitmap.
+static inline bool cov_test(const uint8_t *b,c16_word a){
+    return b[a >> 3] & (1 << (a & 7));
+}
+
+// Ors the src coverage into dest.
+void cov_merge(c16_coverage*,const c16_coverage*);
+
+// Reads a coverage file.
+// return: false if the file does not exist or is not a coverage file.
+bool cov_read(const char*,c16_coverage*);
+
+// Writes a coverage file.
+// return: false if the file could not be written.
+bool cov_write(const char*,const c16_coverage*);
+
+// Merges the running program's coverage into the file, creating it if
+// needed.
+// return: false if the file could not be read or written.
+bool cov_save(const char*);
+
+// Prints the disassembly of the len bytes of code, marking the instructions
+// that were never executed and the directions each jump has gone.
+void cov_report(FILE*,const c16_coverage*,const c16_halfword*,size_t);
+
+#endif
@@ -35,6 +35,16 @@ command commands[COMMAND_COUNT] ={
       "step            Step the ipt over one full operation"                  },
     { "s",cmd_step,0,
       "s               Alias of `step`"                                       },
+    { "continue",cmd_continue,0,
+      "continue        Runs until a breakpoint or the end of the program"     },
+    { "c",cmd_continue,0,
+      "c               Alias of `continue`"                                   },
+    { "run",cmd_run,1,
+      "run HZ          Like `continue` but at HZ ticks per second, ^C stops"  },
+    { "break",cmd_break,1,
+      "break ADR|LBL   Sets a breakpoint at the address or label ADR|LBL"     },
+    { "clear",cmd_clear,1,
+      "clear ADR|LBL   Removes the breakpoint at ADR|LBL"                     },
     { "dump",cmd_dump,0,
       "dump            Prints the values stored in every register"            },
     { "d",cmd_dump,0,
@@ -45,6 +55,14 @@ command commands[COMMAND_COUNT] ={
       "mem w|h ADR|REG Prints the word (w) or halfword (h) in mem at ADR|REG" },
     { "inp", cmd_inp,1,
       "inp STR         Feeds STR to the virtual machines standard input"      },
+    { "coverage",cmd_coverage,0,
+      "coverage        Prints the disassembly marking unexecuted code"        },
+    { "heatmap",cmd_heatmap,1,
+      "heatmap CMD     Prints the hottest memory (show), or on|off|reset"     },
+    { "stats",cmd_stats,1,
+      "stats FMT       Prints internal counters as a table or json, or reset" },
+    { "save",cmd_save,1,
+      "save FILE       Saves the session to FILE, see `16cdb --resume`"       },
     { "help",cmd_help,0,
       "help            Prints this message"                                   },
     { "restart",cmd_restart,0,
@@ -56,9 +74,19 @@ command commands[COMMAND_COUNT] ={
     { NULL,NULL,0,NULL                                                        }
 };
 
-// The handler for when the machine crashes.
+// Whether a tick is running, the only time that `jump` is set by the caller.
+volatile sig_atomic_t ticking = 0;
+
+// The handler for when the machine crashes. A fault outside of a tick is the
+// debugger's own, so it gets the default action instead of a jump into a
+// command that has already returned.
 void sigsegv_handler(int sig){
     char b[30];
+    if (!ticking){
+        signal(sig,SIG_DFL);
+        return;
+    }
+    ticking = 0;
     snprintf(b,30 * sizeof(char),"SIGSEGV caught: ipt = 0x%04x\n",*ipt);
     write(STDOUT_FILENO,b,30 * sizeof(char));
     siglongjmp(jump,1);
@@ -144,6 +172,40 @@ const char *cmdstr(c16_halfword op, bool use_symbols){
     return "";
 }
 
+// Returns the length in bytes of the instruction with the given opcode,
+// including the opcode. Literals and memory addresses are words, registers
+// are a single byte.
+c16_word oplen(c16_halfword op){
+    if (op == OP_TERM || op == OP_SWAP || op == OP_FLUSH || op == OP_NOP){
+        return 1;
+    }
+    if (op <= OP_MAX_REG_REG){             // a, b and the destination
+        return 2 + ((op & 2) ? 1 : 2) + ((op & 1) ? 1 : 2);
+    }else if (op <= OP_LT_REG_REG){        // a register, and b
+        return 2 + ((op % 2 == REG) ? 1 : 2);
+    }else if (op <= OP_SET_REG){           // a and the destination
+        return 2 + ((op % 2 == REG) ? 1 : 2);
+    }else if ((op >> 1) << 1 == OP_PUSH_){
+        return 1 + ((op % 2 == REG) ? 1 : 2);
+    }else if (op <= OP_JMPF){
+        return 3;
+    }else if (op <= OP_WRITE_REG){
+        return 1 + ((op % 2 == REG) ? 1 : 2);
+    }else if (op <= OP_MSET_MEMREG){       // a value then an address
+        switch(op){
+        case OP_MSET_LIT_MEMADDR:
+            return 5;
+        case OP_MSET_LIT_MEMREG:
+        case OP_MSET_REG_MEMADDR:
+        case OP_MSET_MEMADDR:
+            return 4;
+        default:
+            return 3;
+        }
+    }
+    return 2;                              // pop, peek and read take a reg
+}
+
 // Evaluate a line of user input.
 void eval_line(char *s){
     int n,e = 0;
@@ -192,13 +254,22 @@ command *resolve_cmd(char *s){
     return NULL;
 }
 
-// Sets up then begins the repl.
-void start_debug_repl(FILE *in,char *memory_fl){
+// Maps the memory, loads the binary and starts the input thread.
+// return: false if the memory could not be mapped.
+bool init_vm(FILE *in,c16_memmode mode,char *memory_fl,bool lock){
     init_regs();
-    init_mem(&sysmem,memory_fl);
+    if (!init_vmem(&sysmem,&sysvmem,mode,memory_fl,lock)){
+        return false;
+    }
     load_file(&sysmem,0,in);
     fclose(in);
-    pthread_create(&input_thread,NULL,process_stdin,NULL);
+    heat_reset();
+    start_input();
+    return true;
+}
+
+// Sets up then begins the repl.
+void start_debug_repl(void){
     printf("16cdb 0.0.0.1 (2014.3.26)\nWelcome to the 16 candles debugger:\n\
 type `help` to see a list of commands\n");
     repl();
@@ -212,83 +283,8 @@ void repl(){
             continue;
         }
         add_history(s);
-        eval_line(s);
+        STAT_TIME(STAT_CMD,eval_line(s));
         free(s);
     }
     putchar('\n');
 }
-
-
-const char* const usage_str = "Usage: 16cdb [OPTION] BINARY-FILE";
-
-const char* const help_str = "\
-  -h --help                    Prints the help message.\n\
-  -v --version                 Prints version information.\n\
-  -m --memory-file MEMORY-FILE The mmapped memory file to use.\n\
-  -b --binary-file BINARY-FILE The file to debug.";
-
-const char* const version_str = "16cdb " VERSION_NUMBER " " BUILD_DATE "\n\
-Copyright (C) 2014 Joe Jevnik.\n\
-This is free software; see the source for copying conditions.  There is NO\n\
-warranty; not even for MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.";
-
-int main(int argc,char **argv){
-    FILE  *in;
-    int    n,c,cs = 0,opt_ind;
-    char  *memory_fl = C16_DEFAULT_MEM_FILE;
-    static struct option long_ops[] =
-        { { "help",        no_argument,       0, 'h' },
-          { "version",     no_argument,       0, 'v' },
-          { "memory-file", required_argument, 0, 'm' },
-          { "binary-file", required_argument, 0, 'b' },
-          { 0,             0,                 0,  0  } };
-    binary_fl = NULL;
-    if (argc == 1){
-        puts(usage_str);
-        return -1;
-    }
-    for (;;){
-        opt_ind = 0;
-        c = getopt_long(argc,argv,"hvm:b:",long_ops,&opt_ind);
-        if (c == -1){
-            break;
-        }
-        switch(c){
-        case 'h':
-            puts(usage_str);
-            puts(help_str);
-            return 0;
-        case 'v':
-            puts(version_str);
-            return 0;
-        case 'm':
-            memory_fl = optarg;
-            break;
-        case 'b':
-            binary_fl = optarg;
-            break;
-        case '?':
-            return -1;
-        default:
-            printf("Unknown argument: %c\n",c);
-        }
-    }
-    if (opt_ind < argc && !binary_fl){
-        binary_fl = argv[opt_ind + 1];
-    }else if (!binary_fl){
-        puts("16cdb: No input file");
-    }
-    pipe(pipe_fds);
-    signal(SIGSEGV,sigsegv_handler);
-    if (argc == 1){
-        puts("Usage: 16cdb BINARY");
-        return 0;
-    }
-    in = fopen(binary_fl,"r");
-    if (!in){
-        fprintf(stderr,"Error: Unable to open file '%s'\n",binary_fl);
-        return -1;
-    }
-    start_debug_repl(in,memory_fl);
-    return EXIT_SUCCESS;
-}
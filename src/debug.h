@@ -23,6 +23,7 @@
 #include "../16machine/machine/processor.h"
 #include "../16machine/machine/register.h"
 #include "commands.h"
+#include "vmem.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -41,6 +42,9 @@ extern pthread_t input_thread;
 
 extern command commands[];
 
+// Whether a tick is running, see sigsegv_handler().
+extern volatile sig_atomic_t ticking;
+
 // The handler for when the machine crashes.
 void sigsegv_handler(int);
 
@@ -48,14 +52,18 @@ void sigsegv_handler(int);
 // argument denotes whether to print with the symbols or not.
 const char *cmdstr(c16_halfword,bool);
 
+// Returns the length in bytes of the instruction with the given opcode.
+c16_word oplen(c16_halfword);
+
 // Initializes the registers.
 void init_regs(void);
 
-// Frees the registers.
-void free_regs(void);
+// Maps the memory, loads the binary and starts the input thread.
+// return: false if the memory could not be mapped.
+bool init_vm(FILE*,c16_memmode,char*,bool);
 
 // Sets up then begins the repl.
-void start_repl(FILE*,const char*);
+void start_debug_repl(void);
 
 // The debugging read eval print loop.
 void repl(void);
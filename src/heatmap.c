@@ -0,0 +1,132 @@
+/* heatmap.c --- data access counters for the 16candles debugger.
+   Copyright (c) 2014 Joe Jevnik
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 2 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 51
+   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA. */
+
+#include "heatmap.h"
+#include "debug.h"
+
+#include <string.h>
+
+// Whether memory accesses are being counted.
+bool heat_on = false;
+
+// The number of reads and writes of each address.
+uint32_t heat_reads[C16_ADDR_SPACE];
+uint32_t heat_writes[C16_ADDR_SPACE];
+
+// The spt that the stack started at, and the deepest the stack has been.
+c16_word stack_base = 0;
+c16_word stack_max  = 0;
+
+// Whether the last push or pop showed the stack growing down.
+bool stack_down = false;
+
+// A range of memory and how many times it was accessed.
+typedef struct{
+    c16_word addr;
+    uint64_t reads;
+    uint64_t writes;
+}heat_line;
+
+// Zeros the counters and the stack high-water mark.
+void heat_reset(void){
+    memset(heat_reads,0,sizeof(heat_reads));
+    memset(heat_writes,0,sizeof(heat_writes));
+    stack_base = *spt;
+    stack_max  = 0;
+    stack_down = false;
+}
+
+// Reads a register operand as an address.
+static c16_word reg_addr(c16_halfword r){
+    void *p = parse_reg(r);
+    if (!p){
+        return 0;
+    }
+    return (r >= HALFREG_START) ? *((c16_subreg) p) : *((c16_reg) p);
+}
+
+// Reads a word operand.
+static c16_word word_at(c16_word a){
+    return (c16_word) sysmem.mem[a] << 8 | sysmem.mem[(c16_word) (a + 1)];
+}
+
+// Counts the access of the mset whose operands start at the ipt.
+// The msets that store take the value then the address, the ones that load
+// take the address then the register.
+void heat_mset(c16_opcode op){
+    c16_word a = *ipt;
+    if (!heat_on){
+        return;
+    }
+    switch(op){
+    case OP_MSET_REG_MEMADDR:
+        ++heat_writes[word_at(a + 1)];
+        return;
+    case OP_MSET_REG_MEMREG:
+        ++heat_writes[reg_addr(sysmem.mem[(c16_word) (a + 1)])];
+        return;
+    case OP_MSET_LIT_MEMADDR:
+        ++heat_writes[word_at(a + 2)];
+        return;
+    case OP_MSET_LIT_MEMREG:
+        ++heat_writes[reg_addr(sysmem.mem[(c16_word) (a + 2)])];
+        return;
+    case OP_MSET_MEMADDR:
+        ++heat_reads[word_at(a)];
+        return;
+    case OP_MSET_MEMREG:
+        ++heat_reads[reg_addr(sysmem.mem[a])];
+        return;
+    }
+}
+
+// Orders lines from the most to the least accessed for qsort.
+static int heat_cmp(const void *a,const void *b){
+    uint64_t x = ((const heat_line*) a)->reads + ((const heat_line*) a)->writes;
+    uint64_t y = ((const heat_line*) b)->reads + ((const heat_line*) b)->writes;
+    return (x < y) - (x > y);
+}
+
+// Prints the hottest ranges of memory and the deepest the stack has been.
+void heat_print(FILE *out){
+    static heat_line lines[C16_ADDR_SPACE / HEAT_LINE];
+    size_t           n,m;
+    const char      *l;
+    for (n = 0;n < C16_ADDR_SPACE / HEAT_LINE;n++){
+        lines[n].addr   = n * HEAT_LINE;
+        lines[n].reads  = 0;
+        lines[n].writes = 0;
+        for (m = n * HEAT_LINE;m < (n + 1) * HEAT_LINE;m++){
+            lines[n].reads  += heat_reads[m];
+            lines[n].writes += heat_writes[m];
+        }
+    }
+    qsort(lines,C16_ADDR_SPACE / HEAT_LINE,sizeof(heat_line),heat_cmp);
+    if (!heat_on){
+        fputs("note: counting is off, use `heatmap on`\n",out);
+    }
+    fprintf(out,"%-13s %12s %12s  %s\n","range","reads","writes","label");
+    for (n = 0;n < HEAT_TOP && lines[n].reads + lines[n].writes;n++){
+        l = symstr(lines[n].addr);
+        fprintf(out,"0x%04x-0x%04x %12llu %12llu  %s\n",lines[n].addr,
+                lines[n].addr + HEAT_LINE - 1,
+                (unsigned long long) lines[n].reads,
+                (unsigned long long) lines[n].writes,(l) ? l : "");
+    }
+    fprintf(out,"stack: base 0x%04x, max depth %u bytes\n",stack_base,
+            stack_max);
+}
@@ -0,0 +1,110 @@
+/* heatmap.h --- data access counters for the 16candles debugger.
+   Copyright (c) 2014 Joe Jevnik
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 2 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 51
+   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA. */
+
+#ifndef C16_DEBUG_HEATMAP_H
+#define C16_DEBUG_HEATMAP_H
+
+#include "../16common/common/arch.h"
+#include "../16machine/machine/register.h"
+#include "symbols.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// The size of the ranges that the heat map is reported in.
+#define HEAT_LINE 64
+
+// The number of hottest ranges that are reported.
+#define HEAT_TOP 16
+
+// Whether memory accesses are being counted.
+extern bool heat_on;
+
+// The number of reads and writes of each address.
+extern uint32_t heat_reads[C16_ADDR_SPACE];
+extern uint32_t heat_writes[C16_ADDR_SPACE];
+
+// The spt that the stack started at, and the deepest the stack has been.
+extern c16_word stack_base;
+extern c16_word stack_max;
+
+// Whether the last push or pop showed the stack growing down.
+extern bool stack_down;
+
+// Zeros the counters and the stack high-water mark.
+void heat_reset(void);
+
+// Counts the access of the mset whose operands start at the ipt.
+void heat_mset(c16_opcode);
+
+// Prints the hottest ranges of memory and the deepest the stack has been.
+void heat_print(FILE*);
+
+// Counts the accesses to the n addresses starting at a.
+static inline void heat_count(uint32_t *c,c16_word a,c16_word n){
+    while (n--){
+        ++c[a++];
+    }
+}
+
+// Tracks a push that moved the spt from s. Only the pushed word is counted,
+// whichever way the stack grows; the depth is the distance from the base.
+static inline void heat_push(c16_word s){
+    int16_t d = (int16_t) (*spt - stack_base);
+    if (d < 0){
+        d = -d;
+    }
+    if ((c16_word) d > stack_max){
+        stack_max = d;
+    }
+    stack_down = s > *spt;
+    if (heat_on){
+        heat_count(heat_writes,(s < *spt) ? s : *spt,2);
+    }
+}
+
+// Tracks a pop that moved the spt from s.
+static inline void heat_pop(c16_word s){
+    stack_down = s < *spt;
+    if (heat_on){
+        heat_count(heat_reads,(s < *spt) ? s : *spt,2);
+    }
+}
+
+// Tracks a flush, after which the stack is empty and starts at the spt.
+static inline void heat_flush(void){
+    stack_base = *spt;
+}
+
+// Tracks a set that may have moved the spt from s, which starts the stack
+// over there. Arithmetic on the spt only moves within the stack.
+static inline void heat_moved(c16_word s){
+    if (*spt != s){
+        stack_base = *spt;
+    }
+}
+
+// Tracks a peek at the top word of the stack, which is the word below the
+// spt, or at it when the stack grows down.
+static inline void heat_peek(void){
+    if (heat_on){
+        heat_count(heat_reads,(stack_down) ? *spt : *spt - 2,2);
+    }
+}
+
+#endif
@@ -0,0 +1,233 @@
+/* main.c --- entry point of the 16candles debugger.
+   Copyright (c) 2014 Joe Jevnik
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 2 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 51
+   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA. */
+
+#include "debug.h"
+
+const char* const usage_str = "Usage: 16cdb [OPTION] BINARY-FILE";
+
+const char* const help_str = "\
+  -h --help                    Prints the help message.\n\
+  -v --version                 Prints version information.\n\
+  -M --memory MODE             How to back the vm's memory: anon (default)\n\
+                               or file.\n\
+  -m --memory-file MEMORY-FILE The mmapped memory file to use, implies\n\
+                               `--memory file`. Defaults to " C16_DEFAULT_MEM_FILE ".\n\
+  -l --mlock                   Locks anon memory into ram.\n\
+  -b --binary-file BINARY-FILE The file to debug.\n\
+  -C --coverage COV-FILE       Merges the coverage of this session into\n\
+                               COV-FILE on exit.\n\
+     --merge-coverage FILE...  Merges the coverage files into the one given\n\
+                               with --coverage and exits.\n\
+  -r --record INPUT-LOG        Logs the tick at which each input byte was\n\
+                               seen by the vm.\n\
+  -p --replay INPUT-LOG        Replays the input from INPUT-LOG at the same\n\
+                               ticks instead of reading `inp`.\n\
+  -H --heatmap                 Counts the reads and writes of each address\n\
+                               from the start, see `heatmap`.\n\
+  -R --resume SNAPSHOT         Starts from a file written by `save`. The\n\
+                               binary defaults to the one it was saved from.\n\
+  -V --verify N                Checks every tick against 16machine's processor\n\
+                               loop on a second machine, comparing the\n\
+                               memory every N ticks. Input is only given\n\
+                               with --replay.\n\
+  -s --symbol-file SYMBOL-FILE The label map to use, `ADDR LABEL` per line.\n\
+                               Defaults to BINARY-FILE" C16_SYM_SUFFIX " if it exists.";
+
+const char* const version_str = "16cdb " VERSION_NUMBER " " BUILD_DATE "\n\
+Copyright (C) 2014 Joe Jevnik.\n\
+This is free software; see the source for copying conditions.  There is NO\n\
+warranty; not even for MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.";
+
+// The file to merge the session's coverage into, or NULL.
+static char *coverage_fl = NULL;
+
+// Merges the coverage of the session into coverage_fl at exit.
+static void save_coverage(void){
+    if (!cov_save(coverage_fl)){
+        fprintf(stderr,"Error: Unable to write coverage '%s'\n",coverage_fl);
+    }
+}
+
+// Merges the coverage files into coverage_fl.
+// return: the exit status.
+static int merge_coverage(int argc,char **argv){
+    c16_coverage cov;
+    int          n;
+    for (n = 0;n < argc;n++){
+        if (!cov_read(argv[n],&cov)){
+            fprintf(stderr,"Error: '%s' is not a coverage file\n",argv[n]);
+            return -1;
+        }
+        cov_merge(&coverage,&cov);
+    }
+    return (cov_save(coverage_fl)) ? EXIT_SUCCESS : -1;
+}
+
+int main(int argc,char **argv){
+    FILE        *in;
+    int          n,c,cs = 0,opt_ind;
+    char        *memory_fl = C16_DEFAULT_MEM_FILE;
+    char        *symbol_fl = NULL;
+    char        *resume_fl = NULL;
+    bool         lock      = false,merge = false,verify = false;
+    unsigned     verify_n  = 1;
+    c16_memmode  mode      = MEM_ANON;
+    static struct option long_ops[] =
+        { { "help",           no_argument,       0, 'h' },
+          { "version",        no_argument,       0, 'v' },
+          { "memory",         required_argument, 0, 'M' },
+          { "memory-file",    required_argument, 0, 'm' },
+          { "mlock",          no_argument,       0, 'l' },
+          { "binary-file",    required_argument, 0, 'b' },
+          { "symbol-file",    required_argument, 0, 's' },
+          { "coverage",       required_argument, 0, 'C' },
+          { "record",         required_argument, 0, 'r' },
+          { "replay",         required_argument, 0, 'p' },
+          { "verify",         required_argument, 0, 'V' },
+          { "heatmap",        no_argument,       0, 'H' },
+          { "resume",         required_argument, 0, 'R' },
+          { "merge-coverage", no_argument,       0, 'g' },
+          { 0,                0,                 0,  0  } };
+    binary_fl = NULL;
+    if (argc == 1){
+        puts(usage_str);
+        return -1;
+    }
+    for (;;){
+        opt_ind = 0;
+        c = getopt_long(argc,argv,"hvM:m:lb:s:C:r:p:V:HR:",long_ops,&opt_ind);
+        if (c == -1){
+            break;
+        }
+        switch(c){
+        case 'h':
+            puts(usage_str);
+            puts(help_str);
+            return 0;
+        case 'v':
+            puts(version_str);
+            return 0;
+        case 'M':
+            if (!parse_memmode(optarg,&mode)){
+                fprintf(stderr,"Error: '%s' is not a memory mode\n",optarg);
+                return -1;
+            }
+            break;
+        case 'm':
+            memory_fl = optarg;
+            mode      = MEM_FILE;
+            break;
+        case 'l':
+            lock = true;
+            break;
+        case 'b':
+            binary_fl = optarg;
+            break;
+        case 's':
+            symbol_fl = optarg;
+            break;
+        case 'C':
+            coverage_fl = optarg;
+            break;
+        case 'g':
+            merge = true;
+            break;
+        case 'r':
+            if (!init_record(optarg)){
+                fprintf(stderr,"Error: Unable to open file '%s'\n",optarg);
+                return -1;
+            }
+            break;
+        case 'H':
+            heat_on = true;
+            break;
+        case 'R':
+            resume_fl = optarg;
+            break;
+        case 'V':
+            verify   = true;
+            verify_n = strtoul(optarg,NULL,0);
+            break;
+        case 'p':
+            if (!init_replay(optarg)){
+                fprintf(stderr,"Error: '%s' is not an input log\n",optarg);
+                return -1;
+            }
+            break;
+        case '?':
+            return -1;
+        default:
+            printf("Unknown argument: %c\n",c);
+        }
+    }
+    if (merge){
+        if (!coverage_fl){
+            puts("16cdb: --merge-coverage needs --coverage");
+            return -1;
+        }
+        return merge_coverage(argc - optind,&argv[optind]);
+    }
+    if (resume_fl && input_mode != INPUT_LIVE){
+        puts("16cdb: --resume cannot be used with --record or --replay");
+        return -1;
+    }
+    if (optind < argc && !binary_fl){
+        binary_fl = argv[optind];
+    }else if (!binary_fl && resume_fl
+              && !(binary_fl = snapshot_binary(resume_fl))){
+        return -1;
+    }else if (!binary_fl){
+        puts("16cdb: No input file");
+        return -1;
+    }
+    pipe(pipe_fds);
+    signal(SIGSEGV,sigsegv_handler);
+    if (argc == 1){
+        puts("Usage: 16cdb BINARY");
+        return 0;
+    }
+    in = fopen(binary_fl,"r");
+    if (!in){
+        fprintf(stderr,"Error: Unable to open file '%s'\n",binary_fl);
+        return -1;
+    }
+    if (symbol_fl && !load_symbols(&symtab,symbol_fl)){
+        fprintf(stderr,"Error: Unable to load symbols '%s'\n",symbol_fl);
+        return -1;
+    }else if (!symbol_fl){
+        symbol_fl = malloc(strlen(binary_fl) + sizeof(C16_SYM_SUFFIX));
+        sprintf(symbol_fl,"%s" C16_SYM_SUFFIX,binary_fl);
+        load_symbols(&symtab,symbol_fl);
+        free(symbol_fl);
+    }
+    if (coverage_fl){
+        atexit(save_coverage);
+    }
+    if (verify && input_mode == INPUT_RECORD){
+        puts("16cdb: --verify cannot be used with --record");
+        return -1;
+    }else if (verify){
+        input_mode = INPUT_REPLAY;
+    }
+    if (!init_vm(in,mode,memory_fl,lock)
+        || (resume_fl && !load_snapshot(resume_fl))
+        || (verify && !init_verify(verify_n))){
+        return -1;
+    }
+    start_debug_repl();
+    return EXIT_SUCCESS;
+}
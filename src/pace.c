@@ -0,0 +1,117 @@
+/* pace.c --- running the 16candles vm at a fixed rate.
+   Copyright (c) 2014 Joe Jevnik
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 2 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 51
+   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA. */
+
+#include "pace.h"
+#include "util.h"
+
+#include <errno.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+
+extern jmp_buf jump;
+
+// Set by ^C during a paced run.
+static volatile sig_atomic_t interrupted;
+
+// Stops the paced run at the end of the current batch.
+static void sigint_handler(int sig){
+    interrupted = 1;
+}
+
+// Sleeps until the monotonic time t, or until a signal arrives.
+static void sleep_until(uint64_t t){
+    struct timespec ts = { (time_t) (t / 1000000000),(long) (t % 1000000000) };
+    clock_nanosleep(CLOCK_MONOTONIC,TIMER_ABSTIME,&ts,NULL);
+}
+
+// Runs ticks at hz per second in batches, sleeping until each batch's
+// deadline. The deadlines are all taken from the start of the schedule so
+// that the error of one sleep does not carry into the next.
+// return: why the run stopped.
+c16_pacestop pace_run(double hz,int (*tick)(void),c16_pace *p){
+    struct sigaction      sa,old;
+    volatile c16_pacestop r = PACE_INTERRUPT;
+    volatile uint64_t     start,base,n;
+    uint64_t              deadline,t;
+    uint64_t              batch = (uint64_t) (hz * PACE_BATCH_NS / 1e9);
+    int                   s;
+    memset(p,0,sizeof(*p));
+    p->hz = hz;
+    if (!batch){
+        batch = 1;
+    }
+    interrupted = 0;
+    memset(&sa,0,sizeof(sa));
+    sa.sa_handler = sigint_handler;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT,&sa,&old);
+    start = base = now_ns();
+    if (sigsetjmp(jump,1) == 0){
+        for (n = 0;!interrupted;){
+            ++p->batches;
+            for (t = 0;t < batch;t++){
+                ++p->ticks;
+                if ((s = tick())){
+                    r = (c16_pacestop) (s - 1);
+                    goto done;
+                }
+            }
+            n += batch;
+            deadline = base + (uint64_t) (n * 1e9 / hz);
+            t = now_ns();
+            if (t > deadline + PACE_MAX_LAG_NS){
+                ++p->resyncs;
+                base = t;
+                n    = 0;
+            }else if (t > deadline){
+                ++p->late;
+            }else{
+                ++p->sleeps;
+                sleep_until(deadline);
+                t = now_ns() - deadline;
+                if (t < PACE_MAX_LAG_NS){
+                    p->jitter += t;
+                    if (t > p->jitter_max){
+                        p->jitter_max = t;
+                    }
+                }
+            }
+        }
+    }else{
+        r = PACE_CRASH;
+    }
+done:
+    p->ns = now_ns() - start;
+    sigaction(SIGINT,&old,NULL);
+    return r;
+}
+
+// Prints the achieved rate and the timing of a paced run.
+void pace_print(FILE *out,const c16_pace *p){
+    double s  = p->ns / 1e9;
+    double hz = (s > 0) ? p->ticks / s : 0;
+    fprintf(out,"run: %llu ticks in %.3fs, %.1f Hz of %.1f Hz (%.1f%%)\n",
+            (unsigned long long) p->ticks,s,hz,p->hz,hz * 100 / p->hz);
+    fprintf(out,"     %llu batches, %llu sleeps, jitter avg %.1fus max %.1fus,"
+            " %llu late, %llu resyncs\n",
+            (unsigned long long) p->batches,(unsigned long long) p->sleeps,
+            (p->sleeps) ? p->jitter / 1e3 / p->sleeps : 0.0,
+            p->jitter_max / 1e3,(unsigned long long) p->late,
+            (unsigned long long) p->resyncs);
+}
@@ -0,0 +1,64 @@
+/* pace.h --- running the 16candles vm at a fixed rate.
+   Copyright (c) 2014 Joe Jevnik
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 2 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 51
+   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA. */
+
+#ifndef C16_DEBUG_PACE_H
+#define C16_DEBUG_PACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Each batch of ticks is sized to take about this long at the target rate,
+// so slow rates sleep between every tick and fast ones sleep every 1ms.
+#define PACE_BATCH_NS 1000000
+
+// When the run falls this far behind its schedule the missed ticks are
+// dropped instead of being caught up in a burst.
+#define PACE_MAX_LAG_NS 100000000
+
+// Why a paced run stopped.
+typedef enum{
+    PACE_TERM,       // The machine read `term`.
+    PACE_DIVERGED,   // The machine diverged from the reference.
+    PACE_BREAKPOINT, // A breakpoint was hit.
+    PACE_CRASH,      // The machine caused a SIGSEGV.
+    PACE_INTERRUPT,  // The user pressed ^C.
+}c16_pacestop;
+
+// The record of a paced run.
+typedef struct{
+    double   hz;         // The target rate.
+    uint64_t ticks;      // The ticks that were run.
+    uint64_t ns;         // The time the run took.
+    uint64_t batches;    // The batches the ticks were run in.
+    uint64_t sleeps;     // The batches followed by a sleep.
+    uint64_t jitter;     // The total time woken past the deadlines.
+    uint64_t jitter_max; // The latest wakeup.
+    uint64_t late;       // The batches that finished past their deadline.
+    uint64_t resyncs;    // The times the schedule was dropped.
+}c16_pace;
+
+// Runs ticks at hz per second in batches, sleeping until each batch's
+// deadline. Ticks that fall behind are caught up by skipping the sleep,
+// unless the run is more than PACE_MAX_LAG_NS behind. The tick function
+// returns 0 to go on, or a c16_pacestop plus one to stop the run.
+// return: why the run stopped.
+c16_pacestop pace_run(double,int (*)(void),c16_pace*);
+
+// Prints the achieved rate and the timing of a paced run.
+void pace_print(FILE*,const c16_pace*);
+
+#endif
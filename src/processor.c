@@ -19,51 +19,104 @@
 #include "debug.h"
 
 
-// Initializes all registers and subregisters.
-void init_regs(){
-    c16_halfword *rs = calloc(32,sizeof(c16_halfword));
-    ipt   = (c16_reg) &rs[0];
-    spt   = (c16_reg) &rs[2];
-    ac1   = (c16_reg) &rs[4];
-    ac2   = (c16_reg) &rs[6];
-    tst   = (c16_reg) &rs[8];
-    inp   = (c16_reg) &rs[10];
-    inp_r = &rs[10];
-    inp_w = &rs[11];
-    r0    = (c16_reg) &rs[12];
-    r0_f  = &rs[13];
-    r0_b  = &rs[12];
-    r1    = (c16_reg) &rs[14];
-    r1_f  = &rs[15];
-    r1_b  = &rs[14];
-    r2    = (c16_reg) &rs[16];
-    r2_f  = &rs[17];
-    r2_b  = &rs[16];
-    r3    = (c16_reg) &rs[18];
-    r3_f  = &rs[19];
-    r3_b  = &rs[20];
-    r4    = (c16_reg) &rs[20];
-    r4_f  = &rs[21];
-    r4_b  = &rs[29];
-    r5    = (c16_reg) &rs[22];
-    r5_f  = &rs[23];
-    r5_b  = &rs[22];
-    r6    = (c16_reg) &rs[24];
-    r6_f  = &rs[25];
-    r6_b  = &rs[24];
-    r7    = (c16_reg) &rs[26];
-    r7_f  = &rs[27];
-    r7_b  = &rs[26];
-    r8    = (c16_reg) &rs[28];
-    r8_f  = &rs[29];
-    r8_b  = &rs[28];
-    r9    = (c16_reg) &rs[30];
-    r9_f  = &rs[32];
-    r9_b  = &rs[31];
-}
+// The machine's registers, which the pointers in register.h point into.
+c16_regfile regfile;
+
+// The byte offset of each register in a c16_regfile, indexed by register.
+const uint8_t reg_offsets[REG_DNE] = {
+    [OP_ipt]   = offsetof(c16_regfile,ipt),
+    [OP_spt]   = offsetof(c16_regfile,spt),
+    [OP_ac1]   = offsetof(c16_regfile,ac1),
+    [OP_ac2]   = offsetof(c16_regfile,ac2),
+    [OP_tst]   = offsetof(c16_regfile,tst),
+    [OP_inp]   = offsetof(c16_regfile,inp),
+    [OP_r0]    = offsetof(c16_regfile,r[0]),
+    [OP_r1]    = offsetof(c16_regfile,r[1]),
+    [OP_r2]    = offsetof(c16_regfile,r[2]),
+    [OP_r3]    = offsetof(c16_regfile,r[3]),
+    [OP_r4]    = offsetof(c16_regfile,r[4]),
+    [OP_r5]    = offsetof(c16_regfile,r[5]),
+    [OP_r6]    = offsetof(c16_regfile,r[6]),
+    [OP_r7]    = offsetof(c16_regfile,r[7]),
+    [OP_r8]    = offsetof(c16_regfile,r[8]),
+    [OP_r9]    = offsetof(c16_regfile,r[9]),
+    [OP_inp_r] = offsetof(c16_regfile,inp) + REG_LO,
+    [OP_inp_w] = offsetof(c16_regfile,inp) + REG_HI,
+    [OP_r0_f]  = offsetof(c16_regfile,r[0]) + REG_HI,
+    [OP_r0_b]  = offsetof(c16_regfile,r[0]) + REG_LO,
+    [OP_r1_f]  = offsetof(c16_regfile,r[1]) + REG_HI,
+    [OP_r1_b]  = offsetof(c16_regfile,r[1]) + REG_LO,
+    [OP_r2_f]  = offsetof(c16_regfile,r[2]) + REG_HI,
+    [OP_r2_b]  = offsetof(c16_regfile,r[2]) + REG_LO,
+    [OP_r3_f]  = offsetof(c16_regfile,r[3]) + REG_HI,
+    [OP_r3_b]  = offsetof(c16_regfile,r[3]) + REG_LO,
+    [OP_r4_f]  = offsetof(c16_regfile,r[4]) + REG_HI,
+    [OP_r4_b]  = offsetof(c16_regfile,r[4]) + REG_LO,
+    [OP_r5_f]  = offsetof(c16_regfile,r[5]) + REG_HI,
+    [OP_r5_b]  = offsetof(c16_regfile,r[5]) + REG_LO,
+    [OP_r6_f]  = offsetof(c16_regfile,r[6]) + REG_HI,
+    [OP_r6_b]  = offsetof(c16_regfile,r[6]) + REG_LO,
+    [OP_r7_f]  = offsetof(c16_regfile,r[7]) + REG_HI,
+    [OP_r7_b]  = offsetof(c16_regfile,r[7]) + REG_LO,
+    [OP_r8_f]  = offsetof(c16_regfile,r[8]) + REG_HI,
+    [OP_r8_b]  = offsetof(c16_regfile,r[8]) + REG_LO,
+    [OP_r9_f]  = offsetof(c16_regfile,r[9]) + REG_HI,
+    [OP_r9_b]  = offsetof(c16_regfile,r[9]) + REG_LO,
+};
 
-void free_regs(){
-    free(ipt);
+// Initializes all registers and subregisters: zeros the register file and
+// points each of the register.h pointers at its offset in it.
+void init_regs(){
+    static c16_reg* const words[HALFREG_START] = {
+        [OP_ipt] = &ipt,
+        [OP_spt] = &spt,
+        [OP_ac1] = &ac1,
+        [OP_ac2] = &ac2,
+        [OP_tst] = &tst,
+        [OP_inp] = &inp,
+        [OP_r0]  = &r0,
+        [OP_r1]  = &r1,
+        [OP_r2]  = &r2,
+        [OP_r3]  = &r3,
+        [OP_r4]  = &r4,
+        [OP_r5]  = &r5,
+        [OP_r6]  = &r6,
+        [OP_r7]  = &r7,
+        [OP_r8]  = &r8,
+        [OP_r9]  = &r9
+    };
+    static c16_subreg* const halves[REG_DNE] = {
+        [OP_inp_r] = &inp_r,
+        [OP_inp_w] = &inp_w,
+        [OP_r0_f]  = &r0_f,
+        [OP_r0_b]  = &r0_b,
+        [OP_r1_f]  = &r1_f,
+        [OP_r1_b]  = &r1_b,
+        [OP_r2_f]  = &r2_f,
+        [OP_r2_b]  = &r2_b,
+        [OP_r3_f]  = &r3_f,
+        [OP_r3_b]  = &r3_b,
+        [OP_r4_f]  = &r4_f,
+        [OP_r4_b]  = &r4_b,
+        [OP_r5_f]  = &r5_f,
+        [OP_r5_b]  = &r5_b,
+        [OP_r6_f]  = &r6_f,
+        [OP_r6_b]  = &r6_b,
+        [OP_r7_f]  = &r7_f,
+        [OP_r7_b]  = &r7_b,
+        [OP_r8_f]  = &r8_f,
+        [OP_r8_b]  = &r8_b,
+        [OP_r9_f]  = &r9_f,
+        [OP_r9_b]  = &r9_b
+    };
+    int n;
+    memset(&regfile,0,sizeof(regfile));
+    for (n = 0;n < HALFREG_START;n++){
+        *words[n] = reg_in(&regfile,n);
+    }
+    for (n = HALFREG_START;n < REG_DNE;n++){
+        *halves[n] = reg_in(&regfile,n);
+    }
 }
 
 // Fills the register with the next word at the ipt.
@@ -99,95 +152,89 @@ void debugging_op_write(c16_opcode op){
 // simulate one processor tick
 // return: -1 if an exit opcode was encountered
 int proc_tick(){
-    c16_opcode op = sysmem.mem[(*ipt)++];
-    puts(cmdstr(op, false));
+    uint64_t    t  = stat_begin(STAT_TICK);
+    uint64_t    tt;
+    c16_word    a,s;
+    const char *l;
+    c16_opcode  op;
+    input_tick();
+    ++ticks;
+    tt = stat_begin(STAT_TRACE);
+    a  = *ipt;
+    l  = symstr(a);
+    op = sysmem.mem[(*ipt)++];
+    cov_exec(a);
+    if (l){
+        printf("%s: %s\n",l,cmdstr(op,false));
+    }else{
+        puts(cmdstr(op,false));
+    }
+    stat_end(STAT_TRACE,tt);
     if (op == OP_TERM){ // exit case
+        stat_end(STAT_TICK,t);
         return -1;
     }
+    ticking = 1;
     if (op <= OP_MAX_REG_REG){             // binary operators
-        op_bin_ops(op);
+        STAT_TIME(STAT_OP_BIN,op_bin_ops(op));
     }else if (op <= OP_LT_REG_REG){        // comparison operators
-        op_cmp_ops(op);
+        STAT_TIME(STAT_OP_CMP,op_cmp_ops(op));
     }else if (op <= OP_SET_REG){           // unary operators
-        op_un_ops(op);
+        s = *spt;
+        STAT_TIME(STAT_OP_UN,op_un_ops(op));
+        if (op >= OP_SET_LIT){
+            heat_moved(s);
+        }
     }else if ((op >> 1) << 1 == OP_PUSH_){ // op push
-        op_push(op);
+        s = *spt;
+        STAT_TIME(STAT_OP_PUSH,op_push(op));
+        heat_push(s);
     }else if (op <= OP_JMPF){              // jump operations
-        op_jmp(op);
+        STAT_TIME(STAT_OP_JMP,op_jmp(op));
+        if (op != OP_JMP){
+            cov_branch(a,(op == OP_JMPT) == (*tst != 0));
+        }
     }else if (op <= OP_WRITE_REG){         // escaping write
-        debugging_op_write(op);            // DEBUGGING VERSION!
+        STAT_TIME(STAT_OP_WRITE,debugging_op_write(op)); // DEBUGGING VERSION!
     }else if (op <= OP_MSET_MEMREG){       // memset operations
-        op_mset(op);
+        heat_mset(op);
+        STAT_TIME(STAT_OP_MSET,op_mset(op));
     }else if (op == OP_SWAP){              // swap operator
-        op_swap();
+        STAT_TIME(STAT_OP_STACK,op_swap());
     }else if (op == OP_POP){               // pop operator
-        op_pop();
+        s = *spt;
+        STAT_TIME(STAT_OP_STACK,op_pop());
+        heat_pop(s);
     }else if (op == OP_PEEK){              // peek operator
-        op_peek();
+        heat_peek();
+        STAT_TIME(STAT_OP_STACK,op_peek());
     }else if (op == OP_FLUSH){             // flush the stack operator
-        op_flush();
+        STAT_TIME(STAT_OP_STACK,op_flush());
+        heat_flush();
     }else if (op == OP_READ){              // escaping read
-        op_read();
+        STAT_TIME(STAT_OP_READ,op_read());
     }
-
+    ticking = 0;
+    stat_end(STAT_TICK,t);
     return 0;
 }
 
 // Returns the register from the given byte.
 // return: The reg or subreg that the opcode describes.
 void *parse_reg(c16_halfword reg){
-    switch(reg){
-    case OP_ipt:   return ipt;
-    case OP_spt:   return spt;
-    case OP_ac1:   return ac1;
-    case OP_ac2:   return ac2;
-    case OP_tst:   return tst;
-    case OP_inp:   return inp;
-    case OP_inp_r: return inp_r;
-    case OP_inp_w: return inp_w;
-    case OP_r0:    return r0;
-    case OP_r0_f:  return r0_f;
-    case OP_r0_b:  return r0_b;
-    case OP_r1:    return r1;
-    case OP_r1_f:  return r1_f;
-    case OP_r1_b:  return r1_b;
-    case OP_r2:    return r2;
-    case OP_r2_f:  return r2_f;
-    case OP_r2_b:  return r2_b;
-    case OP_r3:    return r3;
-    case OP_r3_f:  return r3_f;
-    case OP_r3_b:  return r3_b;
-    case OP_r4:    return r4;
-    case OP_r4_f:  return r4_f;
-    case OP_r4_b:  return r4_b;
-    case OP_r5:    return r5;
-    case OP_r5_f:  return r5_f;
-    case OP_r5_b:  return r5_b;
-    case OP_r6:    return r6;
-    case OP_r6_f:  return r6_f;
-    case OP_r6_b:  return r6_b;
-    case OP_r7:    return r7;
-    case OP_r7_f:  return r7_f;
-    case OP_r7_b:  return r7_b;
-    case OP_r8:    return r8;
-    case OP_r8_f:  return r8_f;
-    case OP_r8_b:  return r8_b;
-    case OP_r9:    return r9;
-    case OP_r9_f:  return r9_f;
-    case OP_r9_b:  return r9_b;
-    default:       return NULL;
-    }
+    return (reg < REG_DNE) ? reg_in(&regfile,reg) : NULL;
 }
 
 // Process the stdin in a second thread.
 // pass a NULL, it isn't used.
 void *process_stdin(void *_){
     unsigned char c;
+    uint64_t      t;
+    stats_register("input");
     while (read(pipe_fds[0],&c,sizeof(unsigned char))  != 0){
-        sysmem.inputv[(*inp_w)++] = (c16_halfword) c;
-        if (*sysmem.inputc < 256){
-            ++(*sysmem.inputc);
-        }
+        t = stat_begin(STAT_INPUT);
+        queue_input((c16_halfword) c);
+        stat_end(STAT_INPUT,t);
     }
     *sysmem.inputb = 0;
     return NULL;
@@ -0,0 +1,104 @@
+/* reference.c --- 16machine's processor loop, as the verifier's reference.
+   Copyright (c) 2014 Joe Jevnik
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 2 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 51
+   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA. */
+
+// This file is built with the reference's renames, so every register,
+// sysmem, init_regs() and proc_tick() named here is the reference's.
+
+#include "reference.h"
+#include "../16machine/machine/processor.h"
+#include "../16machine/machine/register.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+int  proc_tick(void);
+void init_regs(void);
+
+// The reference's word registers, in the order of a c16_regfile.
+static c16_reg* const words[] = { &ipt,&spt,&ac1,&ac2,&tst,&inp,
+                                  &r0,&r1,&r2,&r3,&r4,&r5,&r6,&r7,&r8,&r9 };
+
+// /dev/null, and the debugger's stdout while the reference writes.
+static int null_fd   = -1;
+static int stdout_fd = -1;
+
+// Sets up the reference's registers with 16machine's init_regs() and gives
+// it the memory to run on.
+// return: false if /dev/null could not be opened for its output.
+bool reference_init(const c16_mem *m){
+    if ((null_fd = open("/dev/null",O_WRONLY)) == -1
+        || (stdout_fd = dup(STDOUT_FILENO)) == -1){
+        perror("16cdb: verify");
+        return false;
+    }
+    init_regs();
+    sysmem = *m;
+    return true;
+}
+
+// Sets the reference's registers.
+void reference_load(const c16_regfile *f){
+    const c16_word *w = (const c16_word*) f;
+    size_t          n;
+    for (n = 0;n < sizeof(words) / sizeof(words[0]);n++){
+        **words[n] = w[n];
+    }
+}
+
+// Reads the reference's registers.
+void reference_save(c16_regfile *f){
+    c16_word *w = (c16_word*) f;
+    size_t    n;
+    for (n = 0;n < sizeof(words) / sizeof(words[0]);n++){
+        w[n] = **words[n];
+    }
+}
+
+// Makes a byte visible to the reference's input.
+void reference_push(c16_halfword c){
+    sysmem.inputv[*inp_w] = c;
+    if (*sysmem.inputc < 256){
+        ++(*sysmem.inputc);
+    }
+    ++(*inp_w);
+}
+
+// Runs one tick of 16machine's processor loop, sending stdout to /dev/null
+// around the ops that write.
+// return: -1 if the reference read `term`.
+int reference_tick(void){
+    c16_opcode op    = sysmem.mem[*ipt];
+    bool       quiet = op > OP_JMPF && op <= OP_WRITE_REG;
+    int        r;
+    if (quiet){
+        fflush(stdout);
+        dup2(null_fd,STDOUT_FILENO);
+    }
+    r = proc_tick();
+    if (quiet){
+        fflush(stdout);
+        dup2(stdout_fd,STDOUT_FILENO);
+    }
+    return r;
+}
+
+// Gives stdout back after reference_tick() was left by a SIGSEGV.
+void reference_recover(void){
+    fflush(stdout);
+    dup2(stdout_fd,STDOUT_FILENO);
+}
@@ -0,0 +1,54 @@
+/* reference.h --- 16machine's processor loop, as the verifier's reference.
+   Copyright (c) 2014 Joe Jevnik
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 2 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 51
+   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA. */
+
+#ifndef C16_DEBUG_REFERENCE_H
+#define C16_DEBUG_REFERENCE_H
+
+#include "../16common/common/arch.h"
+#include "../16machine/machine/memory.h"
+#include "regfile.h"
+
+#include <stdbool.h>
+
+// 16machine's processor.c, operations.c and memory.c are built a second
+// time with every global they share with the debugger renamed (see
+// REF_SYMBOLS in CMakeLists.txt), so the reference has its own registers,
+// memory, register decoding and operations. These are the only ways in.
+
+// Sets up the reference's registers with 16machine's init_regs() and gives
+// it the memory to run on.
+// return: false if /dev/null could not be opened for its output.
+bool reference_init(const c16_mem*);
+
+// Sets the reference's registers.
+void reference_load(const c16_regfile*);
+
+// Reads the reference's registers.
+void reference_save(c16_regfile*);
+
+// Makes a byte visible to the reference's input.
+void reference_push(c16_halfword);
+
+// Runs one tick of 16machine's processor loop. What the reference writes is
+// thrown away, the debugger's machine has already written it.
+// return: -1 if the reference read `term`.
+int reference_tick(void);
+
+// Gives stdout back after reference_tick() was left by a SIGSEGV.
+void reference_recover(void);
+
+#endif
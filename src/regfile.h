@@ -0,0 +1,69 @@
+/* regfile.h --- the 16candles vm's registers as one block.
+   Copyright (c) 2014 Joe Jevnik
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 2 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 51
+   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA. */
+
+#ifndef C16_DEBUG_REGFILE_H
+#define C16_DEBUG_REGFILE_H
+
+#include "../16common/common/arch.h"
+#include "../16machine/machine/register.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// The constant for register does not exist.
+#define REG_DNE 38
+
+// The index where halfregs start.
+#define HALFREG_START 16
+
+// The offsets of the high and low bytes of a word.
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define REG_HI 0
+#define REG_LO 1
+#else
+#define REG_HI 1
+#define REG_LO 0
+#endif
+
+// Every register. The subregisters are bytes of these: rN_f is the high
+// byte of rN and rN_b the low, inp_w is the high byte of inp and inp_r the
+// low. The whole file is copied or compared at once to snapshot it.
+typedef struct{
+    c16_word ipt;
+    c16_word spt;
+    c16_word ac1;
+    c16_word ac2;
+    c16_word tst;
+    c16_word inp;
+    c16_word r[10];
+}__attribute__((packed,aligned(8))) c16_regfile;
+
+_Static_assert(sizeof(c16_regfile) == 32,"the register file is 32 bytes");
+
+// The machine's registers, which the pointers in register.h point into.
+extern c16_regfile regfile;
+
+// The byte offset of each register in a c16_regfile, indexed by register.
+extern const uint8_t reg_offsets[REG_DNE];
+
+// Returns a pointer to a register of a register file. The register must
+// be less than REG_DNE.
+static inline void *reg_in(c16_regfile *f,c16_halfword r){
+    return (c16_halfword*) f + reg_offsets[r];
+}
+
+#endif
@@ -0,0 +1,193 @@
+/* replay.c --- recording and replaying the 16candles vm's input.
+   Copyright (c) 2014 Joe Jevnik
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 2 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 51
+   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA. */
+
+#include "replay.h"
+#include "verify.h"
+
+#include <string.h>
+#include <unistd.h>
+
+// Where the vm's input comes from.
+c16_inputmode input_mode = INPUT_LIVE;
+
+// The number of ticks executed this session.
+uint64_t ticks = 0;
+
+// The tick at which the next replayed byte becomes visible, UINT64_MAX once
+// the log is exhausted.
+uint64_t replay_next = UINT64_MAX;
+
+// The byte that becomes visible at replay_next.
+static c16_halfword replay_byte;
+
+// The log being written or read. It is NULL when replaying for --verify
+// without --replay, which gives the vm no input at all.
+static FILE *input_log = NULL;
+
+// The tick of the last record.
+static uint64_t log_tick = 0;
+
+// The bytes the input thread has read while recording, that the vm's thread
+// has not made visible yet. The thread only writes pending_w and the vm only
+// writes pending_r.
+static c16_halfword pending[256];
+static uint32_t     pending_w = 0;
+static uint32_t     pending_r = 0;
+
+// Whether the input thread is running.
+static bool input_running = false;
+
+void *process_stdin(void*);
+
+// Starts logging the input to the file.
+// return: false if the file could not be created.
+bool init_record(const char *fl){
+    if (!(input_log = fopen(fl,"wb"))){
+        return false;
+    }
+    fputs(INPUT_LOG_MAGIC,input_log);
+    fputc(INPUT_LOG_VERSION,input_log);
+    input_mode = INPUT_RECORD;
+    return true;
+}
+
+// Reads the next record of the log into replay_next and replay_byte.
+static void replay_advance(void){
+    uint64_t d = 0;
+    int      c,s;
+    for (s = 0;(c = fgetc(input_log)) != EOF;s += 7){
+        d |= (uint64_t) (c & 0x7f) << s;
+        if (!(c & 0x80)){
+            break;
+        }
+    }
+    if (c == EOF || (c = fgetc(input_log)) == EOF){
+        replay_next = UINT64_MAX;
+        return;
+    }
+    log_tick   += d;
+    replay_next = log_tick;
+    replay_byte = (c16_halfword) c;
+}
+
+// Starts replaying the input from the log.
+// return: false if the file is not an input log.
+bool init_replay(const char *fl){
+    char magic[sizeof(INPUT_LOG_MAGIC) - 1];
+    if (!(input_log = fopen(fl,"rb"))){
+        return false;
+    }
+    if (fread(magic,sizeof(magic),1,input_log) != 1
+        || memcmp(magic,INPUT_LOG_MAGIC,sizeof(magic))
+        || fgetc(input_log) != INPUT_LOG_VERSION){
+        fclose(input_log);
+        return false;
+    }
+    input_mode = INPUT_REPLAY;
+    replay_advance();
+    return true;
+}
+
+// Starts the log and the tick count over, for a restart of the vm.
+void rewind_input(void){
+    ticks     = 0;
+    log_tick  = 0;
+    pending_r = pending_w;
+    if (input_mode == INPUT_RECORD){
+        fflush(input_log);
+        if (ftruncate(fileno(input_log),INPUT_LOG_HEADER)){
+            perror("16cdb: record");
+        }
+        fseek(input_log,INPUT_LOG_HEADER,SEEK_SET);
+    }else if (input_mode == INPUT_REPLAY && input_log){
+        fseek(input_log,INPUT_LOG_HEADER,SEEK_SET);
+        replay_advance();
+    }
+}
+
+// Starts the input thread unless the input is being replayed.
+void start_input(void){
+    if (input_mode != INPUT_REPLAY){
+        pthread_create(&input_thread,NULL,process_stdin,NULL);
+        input_running = true;
+    }
+}
+
+// Stops the input thread.
+void stop_input(void){
+    if (input_running){
+        pthread_cancel(input_thread);
+        pthread_join(input_thread,NULL);
+        input_running = false;
+    }
+}
+
+// Makes a byte visible to the vm. The byte is stored and counted in inputc,
+// which is what op_read() checks, before inp_w moves past it.
+void push_input(c16_halfword c){
+    sysmem.inputv[*inp_w] = c;
+    if (*sysmem.inputc < 256){
+        __atomic_add_fetch(sysmem.inputc,1,__ATOMIC_RELEASE);
+    }
+    __atomic_store_n(inp_w,(c16_halfword) (*inp_w + 1),__ATOMIC_RELEASE);
+    if (verifying){
+        verify_push(c);
+    }
+}
+
+// Hands a byte read by the input thread to the vm: straight away, or when
+// recording, at the start of the vm's next tick, so that the tick it is
+// logged at is the tick the vm could first read it.
+void queue_input(c16_halfword c){
+    if (input_mode != INPUT_RECORD){
+        push_input(c);
+        return;
+    }
+    while (pending_w - __atomic_load_n(&pending_r,__ATOMIC_ACQUIRE)
+           >= sizeof(pending)){
+        usleep(1000);
+    }
+    pending[pending_w % sizeof(pending)] = c;
+    __atomic_store_n(&pending_w,pending_w + 1,__ATOMIC_RELEASE);
+}
+
+// Makes the bytes the input thread has read since the last tick visible,
+// and logs them at this tick.
+void record_input(void){
+    uint32_t     w = __atomic_load_n(&pending_w,__ATOMIC_ACQUIRE);
+    uint64_t     d;
+    c16_halfword c;
+    for (;pending_r != w;){
+        c = pending[pending_r % sizeof(pending)];
+        push_input(c);
+        for (d = ticks - log_tick;d >= 0x80;d >>= 7){
+            fputc((int) (d & 0x7f) | 0x80,input_log);
+        }
+        fputc((int) d,input_log);
+        fputc(c,input_log);
+        log_tick = ticks;
+        __atomic_store_n(&pending_r,pending_r + 1,__ATOMIC_RELEASE);
+    }
+}
+
+// Makes the replayed bytes for this tick visible.
+void replay_input(void){
+    while (replay_next == ticks){
+        push_input(replay_byte);
+        replay_advance();
+    }
+}
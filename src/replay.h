@@ -0,0 +1,97 @@
+/* replay.h --- recording and replaying the 16candles vm's input.
+   Copyright (c) 2014 Joe Jevnik
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 2 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 51
+   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA. */
+
+#ifndef C16_DEBUG_REPLAY_H
+#define C16_DEBUG_REPLAY_H
+
+#include "../16common/common/arch.h"
+#include "../16machine/machine/memory.h"
+#include "../16machine/machine/register.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <pthread.h>
+
+// The magic number and version at the start of an input log.
+#define INPUT_LOG_MAGIC   "16CDBINP"
+#define INPUT_LOG_VERSION 1
+#define INPUT_LOG_HEADER  (sizeof(INPUT_LOG_MAGIC) - 1 + 1)
+
+// Where the vm's input comes from.
+typedef enum{
+    INPUT_LIVE,   // The input thread, fed by `inp`.
+    INPUT_RECORD, // The input thread, logging when each byte became visible.
+    INPUT_REPLAY, // A log, with no thread.
+}c16_inputmode;
+
+// Where the vm's input comes from.
+extern c16_inputmode input_mode;
+
+// The number of ticks executed this session.
+extern uint64_t ticks;
+
+// The input thread.
+extern pthread_t input_thread;
+
+// The tick at which the next replayed byte becomes visible.
+extern uint64_t replay_next;
+
+// Starts logging the input to the file.
+// An input log is INPUT_LOG_MAGIC, a version byte, then one record per byte:
+// the ticks since the last record as an unsigned LEB128 varint, then the
+// byte itself.
+// return: false if the file could not be created.
+bool init_record(const char*);
+
+// Starts replaying the input from the log.
+// return: false if the file is not an input log.
+bool init_replay(const char*);
+
+// Starts the input thread unless the input is being replayed.
+void start_input(void);
+
+// Stops the input thread.
+void stop_input(void);
+
+// Starts the log and the tick count over, for a restart of the vm.
+void rewind_input(void);
+
+// Makes a byte visible to the vm.
+void push_input(c16_halfword);
+
+// Hands a byte read by the input thread to the vm: straight away, or when
+// recording, at the start of the vm's next tick.
+void queue_input(c16_halfword);
+
+// Makes the bytes the input thread has read since the last tick visible,
+// and logs them at this tick.
+void record_input(void);
+
+// Makes the replayed bytes for this tick visible.
+void replay_input(void);
+
+// Records or replays the input at the start of a tick.
+static inline void input_tick(void){
+    if (input_mode == INPUT_RECORD){
+        record_input();
+    }else if (input_mode == INPUT_REPLAY && replay_next == ticks){
+        replay_input();
+    }
+}
+
+#endif
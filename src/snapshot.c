@@ -0,0 +1,225 @@
+/* snapshot.c --- saving and resuming debugging sessions.
+   Copyright (c) 2014 Joe Jevnik
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 2 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 51
+   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA. */
+
+#include "snapshot.h"
+#include "debug.h"
+#include "util.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Returns the sum of a snapshot: everything after the sum field.
+static uint64_t snap_sum(const c16_snapshot *s){
+    size_t off = offsetof(c16_snapshot,sum) + sizeof(s->sum);
+    return fnv(FNV_BASIS,(const uint8_t*) s + off,s->len - off);
+}
+
+// Reads the binary as load_file() sees it into img, zero padded, and hashes
+// the whole file.
+// return: false if the binary could not be read.
+static bool read_binary(const char *fl,c16_halfword *img,uint64_t *size,
+                        uint64_t *hash){
+    c16_halfword b[4096];
+    FILE        *in = fopen(fl,"r");
+    size_t       n;
+    if (!in){
+        return false;
+    }
+    memset(img,0,C16_ADDR_SPACE);
+    *size = 0;
+    *hash = FNV_BASIS;
+    while ((n = fread(b,1,sizeof(b),in))){
+        if (*size < C16_ADDR_SPACE){
+            memcpy(img + *size,b,(*size + n > C16_ADDR_SPACE)
+                   ? C16_ADDR_SPACE - *size : n);
+        }
+        *hash  = fnv(*hash,b,n);
+        *size += n;
+    }
+    fclose(in);
+    return true;
+}
+
+// Writes the state of the machine and the breakpoints to the file.
+// The pages that are still the same as the binary are only referred to.
+// The file is written beside its name and renamed over it, so an old
+// snapshot is never left half written.
+// return: false if the file could not be written.
+bool save_snapshot(const char *fl){
+    static c16_halfword img[C16_ADDR_SPACE];
+    c16_snapshot       *s;
+    char                path[PATH_MAX],*tmp;
+    uint32_t            n,p,data,len;
+    FILE               *out;
+    bool                r;
+    if (!realpath(binary_fl,path)){
+        strncpy(path,binary_fl,sizeof(path) - 1);
+        path[sizeof(path) - 1] = 0;
+    }
+    data = (sizeof(*s) + strlen(path) + SNAP_PAGE - 1) / SNAP_PAGE * SNAP_PAGE;
+    s    = calloc(1,data + C16_ADDR_SPACE);
+    if (!s || !read_binary(binary_fl,img,&s->bin_size,&s->bin_hash)){
+        fprintf(stderr,"Error: Unable to read file '%s'\n",binary_fl);
+        free(s);
+        return false;
+    }
+    memcpy(s->magic,SNAP_MAGIC,sizeof(s->magic));
+    s->version  = SNAP_VERSION;
+    s->ticks    = ticks;
+    s->path_len = strlen(path);
+    s->data     = data;
+    memcpy((char*) (s + 1),path,s->path_len);
+    for (n = 0,p = 0;n < SNAP_PAGES;n++){
+        if (memcmp(sysmem.mem + n * SNAP_PAGE,img + n * SNAP_PAGE,SNAP_PAGE)){
+            memcpy((uint8_t*) s + data + p * SNAP_PAGE,
+                   sysmem.mem + n * SNAP_PAGE,SNAP_PAGE);
+            s->pages[n] = ++p;
+        }
+    }
+    s->regs   = regfile;
+    memcpy(s->inputv,sysmem.inputv,sizeof(s->inputv));
+    s->inputc = *sysmem.inputc;
+    s->inputb = *sysmem.inputb;
+    for (n = 0;n < C16_ADDR_SPACE;n++){
+        s->breaks[n / 8] |= breakpoints[n] << (n % 8);
+    }
+    len    = s->len = data + p * SNAP_PAGE;
+    s->sum = snap_sum(s);
+    tmp    = malloc(strlen(fl) + 5);
+    sprintf(tmp,"%s.tmp",fl);
+    r = (out = fopen(tmp,"w")) && fwrite(s,1,len,out) == len;
+    if (out && fclose(out)){
+        r = false;
+    }
+    if (r && rename(tmp,fl)){
+        r = false;
+    }
+    if (!r){
+        fprintf(stderr,"Error: Unable to write file '%s'\n",fl);
+        unlink(tmp);
+    }
+    free(tmp);
+    free(s);
+    return r;
+}
+
+// Maps a snapshot and checks its header, length and sum.
+// return: the mapping, or NULL with the error printed.
+static const c16_snapshot *map_snapshot(const char *fl){
+    const c16_snapshot *s;
+    struct stat         st;
+    int                 fd = open(fl,O_RDONLY);
+    if (fd == -1 || fstat(fd,&st)){
+        fprintf(stderr,"Error: Unable to open file '%s'\n",fl);
+        if (fd != -1){
+            close(fd);
+        }
+        return NULL;
+    }
+    if ((size_t) st.st_size < sizeof(*s)){
+        close(fd);
+        fprintf(stderr,"Error: '%s' is not a snapshot\n",fl);
+        return NULL;
+    }
+    s = mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+    close(fd);
+    if (s == MAP_FAILED){
+        perror("16cdb: mmap");
+        return NULL;
+    }
+    if (memcmp(s->magic,SNAP_MAGIC,sizeof(s->magic))
+        || s->version != SNAP_VERSION){
+        fprintf(stderr,"Error: '%s' is not a version %d snapshot\n",fl,
+                SNAP_VERSION);
+    }else if (s->len != st.st_size || s->data < sizeof(*s) + s->path_len
+              || s->data > s->len || snap_sum(s) != s->sum){
+        fprintf(stderr,"Error: '%s' is corrupt\n",fl);
+    }else{
+        return s;
+    }
+    munmap((void*) s,st.st_size);
+    return NULL;
+}
+
+// Reads the path of the binary that a snapshot was taken of.
+// return: the path, to be freed, or NULL if the file is not a snapshot.
+char *snapshot_binary(const char *fl){
+    const c16_snapshot *s = map_snapshot(fl);
+    char               *path;
+    if (!s){
+        return NULL;
+    }
+    if ((path = malloc(s->path_len + 1))){
+        memcpy(path,(const char*) (s + 1),s->path_len);
+        path[s->path_len] = 0;
+    }
+    munmap((void*) s,s->len);
+    return path;
+}
+
+// Restores the machine from a snapshot. The pages that refer to the binary
+// are copied from it, and the rest straight out of the mapping.
+// return: false if the snapshot could not be restored.
+bool load_snapshot(const char *fl){
+    static c16_halfword img[C16_ADDR_SPACE];
+    const c16_snapshot *s = map_snapshot(fl);
+    uint64_t            size,hash;
+    uint32_t            n;
+    if (!s){
+        return false;
+    }
+    if (!read_binary(binary_fl,img,&size,&hash)
+        || size != s->bin_size || hash != s->bin_hash){
+        fprintf(stderr,"Error: '%s' is not the binary '%s' was taken of\n",
+                binary_fl,fl);
+        munmap((void*) s,s->len);
+        return false;
+    }
+    for (n = 0;n < SNAP_PAGES;n++){
+        if (s->pages[n]
+            && s->data + (size_t) s->pages[n] * SNAP_PAGE > s->len){
+            fprintf(stderr,"Error: '%s' is corrupt\n",fl);
+            munmap((void*) s,s->len);
+            return false;
+        }
+    }
+    stop_input();
+    for (n = 0;n < SNAP_PAGES;n++){
+        memcpy(sysmem.mem + n * SNAP_PAGE,(s->pages[n])
+               ? (const c16_halfword*) s + s->data
+                 + (s->pages[n] - 1) * SNAP_PAGE
+               : img + n * SNAP_PAGE,SNAP_PAGE);
+    }
+    regfile   = s->regs;
+    stop_regs = regfile;
+    memcpy(sysmem.inputv,s->inputv,sizeof(s->inputv));
+    *sysmem.inputc = s->inputc;
+    *sysmem.inputb = s->inputb;
+    for (n = 0;n < C16_ADDR_SPACE;n++){
+        breakpoints[n] = (s->breaks[n / 8] >> (n % 8)) & 1;
+    }
+    ticks = s->ticks;
+    munmap((void*) s,s->len);
+    heat_reset();
+    start_input();
+    if (verifying){
+        verify_sync();
+    }
+    return true;
+}
@@ -0,0 +1,72 @@
+/* snapshot.h --- saving and resuming debugging sessions.
+   Copyright (c) 2014 Joe Jevnik
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 2 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 51
+   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA. */
+
+#ifndef C16_DEBUG_SNAPSHOT_H
+#define C16_DEBUG_SNAPSHOT_H
+
+#include "../16common/common/arch.h"
+#include "symbols.h"
+#include "regfile.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// The magic number and version at the start of a snapshot.
+#define SNAP_MAGIC   "16CDBSNP"
+#define SNAP_VERSION 1
+
+// Memory is stored, or referred to the binary, a page at a time.
+#define SNAP_PAGE  4096
+#define SNAP_PAGES (C16_ADDR_SPACE / SNAP_PAGE)
+
+// The header of a snapshot, in the host's byte order. It is followed by
+// the path of the binary, then, from the page aligned offset `data`, the
+// pages of memory that differ from the binary.
+typedef struct{
+    char         magic[8];                   // SNAP_MAGIC.
+    uint32_t     version;                    // SNAP_VERSION.
+    uint32_t     len;                        // The length of the whole file.
+    uint64_t     sum;                        // FNV-1a of the rest of the file.
+    uint64_t     ticks;                      // The ticks run when saved.
+    uint64_t     bin_size;                   // The size of the binary.
+    uint64_t     bin_hash;                   // FNV-1a of the binary.
+    uint32_t     path_len;                   // The length of the path.
+    uint32_t     data;                       // The offset of the pages.
+    uint16_t     pages[SNAP_PAGES];          // 0 for the binary's page, or
+                                             // n for the nth stored page.
+    c16_regfile  regs;                       // The registers.
+    c16_halfword inputv[256];                // The input buffer.
+    c16_word     inputc;                     // The bytes in the buffer.
+    c16_halfword inputb;                     // The input flag.
+    uint8_t      breaks[C16_ADDR_SPACE / 8]; // The breakpoints, as bits.
+}c16_snapshot;
+
+// Writes the state of the machine and the breakpoints to the file.
+// return: false if the file could not be written.
+bool save_snapshot(const char*);
+
+// Reads the path of the binary that a snapshot was taken of.
+// return: the path, to be freed, or NULL if the file is not a snapshot.
+char *snapshot_binary(const char*);
+
+// Restores the machine from a snapshot of binary_fl. The file is mapped
+// rather than read, and checked against its sum and against the binary
+// before anything is changed.
+// return: false if the snapshot could not be restored.
+bool load_snapshot(const char*);
+
+#endif
@@ -0,0 +1,114 @@
+/* stats.c --- counters for the 16candles debugger's internals.
+   Copyright (c) 2014 Joe Jevnik
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 2 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 51
+   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA. */
+
+#include "stats.h"
+
+#include <pthread.h>
+#include <string.h>
+
+// The counters of every thread; slot 0 is the main thread, and is used by
+// any thread that never registered.
+static c16_stats stats_threads[STATS_MAX_THREADS] = { { .name = "main" } };
+
+// The number of slots in use.
+static int stats_threadc = 1;
+
+// Guards registration.
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// The counters of the calling thread.
+__thread c16_stats *stats_local = &stats_threads[0];
+
+// The names of the phases, indexed by c16_stat.
+const char* const stat_strs[] = { "tick",
+                                  "op_bin",
+                                  "op_cmp",
+                                  "op_un",
+                                  "op_push",
+                                  "op_jmp",
+                                  "op_write",
+                                  "op_mset",
+                                  "op_stack",
+                                  "op_read",
+                                  "break",
+                                  "input",
+                                  "trace",
+                                  "cmd" };
+
+// Gives the calling thread its own counters under the given name, reusing
+// the counters of an earlier thread with the same name.
+void stats_register(const char *name){
+    int n;
+    pthread_mutex_lock(&stats_lock);
+    for (n = 0;n < stats_threadc;n++){
+        if (!strcmp(stats_threads[n].name,name)){
+            break;
+        }
+    }
+    if (n == stats_threadc && n < STATS_MAX_THREADS){
+        stats_threads[stats_threadc++].name = name;
+    }
+    stats_local = &stats_threads[(n < STATS_MAX_THREADS) ? n : 0];
+    pthread_mutex_unlock(&stats_lock);
+}
+
+// Zeros every thread's counters.
+void stats_reset(void){
+    int n;
+    for (n = 0;n < stats_threadc;n++){
+        memset(stats_threads[n].ctr,0,sizeof(stats_threads[n].ctr));
+    }
+}
+
+// Prints the counters as a table, or as json.
+void stats_print(FILE *out,bool json){
+    int                n,m;
+    bool               first = true;
+    const c16_statctr *c;
+    double             avg;
+    if (json){
+        fprintf(out,"{\"unit\":\"" STATS_UNIT "\",\"sample_every\":%d,"
+                "\"stats\":[",STATS_SAMPLE_MASK + 1);
+    }else{
+        fprintf(out,"%-8s %-9s %14s %12s %16s\n","thread","phase","count",
+                "avg " STATS_UNIT,"est. total");
+    }
+    for (n = 0;n < stats_threadc;n++){
+        for (m = 0;m < STAT_COUNT;m++){
+            c = &stats_threads[n].ctr[m];
+            if (!c->count){
+                continue;
+            }
+            avg = (c->sampled) ? (double) c->cycles / c->sampled : 0;
+            if (json){
+                fprintf(out,"%s{\"thread\":\"%s\",\"phase\":\"%s\","
+                        "\"count\":%llu,\"sampled\":%llu,\"avg\":%.1f}",
+                        (first) ? "" : ",",stats_threads[n].name,stat_strs[m],
+                        (unsigned long long) c->count,
+                        (unsigned long long) c->sampled,avg);
+                first = false;
+            }else{
+                fprintf(out,"%-8s %-9s %14llu %12.1f %16.0f\n",
+                        stats_threads[n].name,stat_strs[m],
+                        (unsigned long long) c->count,avg,avg * c->count);
+            }
+        }
+    }
+    if (json){
+        fputs("]}\n",out);
+    }
+}
@@ -0,0 +1,125 @@
+/* stats.h --- counters for the 16candles debugger's internals.
+   Copyright (c) 2014 Joe Jevnik
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 2 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 51
+   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA. */
+
+#ifndef C16_DEBUG_STATS_H
+#define C16_DEBUG_STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define STATS_UNIT "cycles"
+#else
+#define STATS_UNIT "ns"
+#endif
+
+// The size of a cache line; each thread's counters start on their own.
+#define STATS_LINE 64
+
+// The most threads that get their own counters.
+#define STATS_MAX_THREADS 4
+
+// One in every 2^STATS_SAMPLE_SHIFT entries into a phase is timed.
+#define STATS_SAMPLE_SHIFT 6
+#define STATS_SAMPLE_MASK  ((1 << STATS_SAMPLE_SHIFT) - 1)
+
+// The phases of the debugger that are counted.
+typedef enum{
+    STAT_TICK,     // A whole proc_tick(): decode, dispatch and the op.
+    STAT_OP_BIN,   // op_bin_ops().
+    STAT_OP_CMP,   // op_cmp_ops().
+    STAT_OP_UN,    // op_un_ops().
+    STAT_OP_PUSH,  // op_push().
+    STAT_OP_JMP,   // op_jmp().
+    STAT_OP_WRITE, // debugging_op_write().
+    STAT_OP_MSET,  // op_mset().
+    STAT_OP_STACK, // op_swap(), op_pop(), op_peek() and op_flush().
+    STAT_OP_READ,  // op_read().
+    STAT_BREAK,    // Breakpoint checks.
+    STAT_INPUT,    // Wakeups of the input thread.
+    STAT_TRACE,    // Writing the trace of a tick.
+    STAT_CMD,      // Evaluating a line in the repl.
+    STAT_COUNT,
+}c16_stat;
+
+// The counter for a single phase.
+typedef struct{
+    uint64_t count;   // The number of times the phase was entered.
+    uint64_t sampled; // The number of those that were timed.
+    uint64_t cycles;  // The time spent in the timed entries.
+}c16_statctr;
+
+// The counters of one thread, padded out to whole cache lines.
+typedef struct{
+    c16_statctr ctr[STAT_COUNT];
+    const char *name;
+}__attribute__((aligned(STATS_LINE))) c16_stats;
+
+// The counters of the calling thread.
+extern __thread c16_stats *stats_local;
+
+// The names of the phases, indexed by c16_stat.
+extern const char* const stat_strs[];
+
+// Gives the calling thread its own counters under the given name, reusing
+// the counters of an earlier thread with the same name.
+void stats_register(const char*);
+
+// Zeros every thread's counters.
+void stats_reset(void);
+
+// Prints the counters as a table, or as json.
+void stats_print(FILE*,bool);
+
+// Reads the cycle counter, or the monotonic clock in ns where there is none.
+static inline uint64_t stats_now(void){
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC,&t);
+    return (uint64_t) t.tv_sec * 1000000000 + t.tv_nsec;
+#endif
+}
+
+// Counts an entry into a phase.
+// return: the start time if this entry is sampled, otherwise 0.
+static inline uint64_t stat_begin(c16_stat s){
+    return ((stats_local->ctr[s].count++ & STATS_SAMPLE_MASK) == 0)
+        ? stats_now() : 0;
+}
+
+// Ends an entry into a phase that was started with stat_begin().
+static inline void stat_end(c16_stat s,uint64_t t){
+    if (t){
+        ++stats_local->ctr[s].sampled;
+        stats_local->ctr[s].cycles += stats_now() - t;
+    }
+}
+
+// Counts and samples the time of a statement as the given phase.
+#define STAT_TIME(s,stmt)                       \
+    do{                                         \
+        uint64_t stat_t_ = stat_begin(s);       \
+        stmt;                                   \
+        stat_end(s,stat_t_);                    \
+    }while (0)
+
+#endif
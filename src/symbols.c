@@ -0,0 +1,153 @@
+/* symbols.c --- label maps for the 16candles debugger.
+   Copyright (c) 2014 Joe Jevnik
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 2 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 51
+   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA. */
+
+#include "symbols.h"
+
+#include <string.h>
+
+// The symbols for the binary being debugged.
+c16_symtab symtab;
+
+// Hashes a label name (32 bit FNV-1a).
+static uint32_t sym_hash(const char *s){
+    uint32_t h = 2166136261u;
+    while (*s){
+        h ^= (unsigned char) *s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// Orders symbols by address for qsort.
+static int sym_cmp(const void *a,const void *b){
+    return (int) ((const c16_sym*) a)->addr - (int) ((const c16_sym*) b)->addr;
+}
+
+// Builds the address table and the name hash from the sorted symbols.
+static void index_symbols(c16_symtab *t){
+    size_t   n,h,size = 16;
+    uint32_t a,end;
+    memset(t->by_addr,0,sizeof(t->by_addr));
+    for (n = 0;n < t->symc;n++){
+        end = (n + 1 < t->symc) ? t->syms[n + 1].addr : C16_ADDR_SPACE;
+        for (a = t->syms[n].addr;a < end;a++){
+            t->by_addr[a] = (uint32_t) n + 1;
+        }
+    }
+    while (size < t->symc * 2){
+        size <<= 1;
+    }
+    t->by_name   = calloc(size,sizeof(uint32_t));
+    t->hash_mask = size - 1;
+    for (n = 0;n < t->symc;n++){
+        h = sym_hash(t->syms[n].name) & t->hash_mask;
+        while (t->by_name[h] != SYM_NONE){
+            h = (h + 1) & t->hash_mask;
+        }
+        t->by_name[h] = (uint32_t) n + 1;
+    }
+}
+
+// Loads the symbol map file into the table, replacing what was there.
+// return: false if the file could not be read or is malformed.
+bool load_symbols(c16_symtab *t,const char *fl){
+    FILE   *in;
+    char    line[256],*a,*name,*e;
+    long    l;
+    size_t  cap  = 64,lineno = 0;
+    if (!(in = fopen(fl,"r"))){
+        return false;
+    }
+    free_symbols(t);
+    t->syms = malloc(cap * sizeof(c16_sym));
+    while (fgets(line,sizeof(line),in)){
+        ++lineno;
+        a = strtok(line," \t\r\n");
+        if (!a || *a == '#'){
+            continue;
+        }
+        name = strtok(NULL," \t\r\n");
+        l    = strtol(a,&e,0);
+        if (!name || *e != '\0' || l < 0 || l > 0xffff){
+            fprintf(stderr,"%s:%zu: expected `ADDR LABEL`\n",fl,lineno);
+            fclose(in);
+            free_symbols(t);
+            return false;
+        }
+        if ((e = strchr(name,':'))){
+            *e = '\0';
+        }
+        if (t->symc == cap){
+            cap    *= 2;
+            t->syms = realloc(t->syms,cap * sizeof(c16_sym));
+        }
+        t->syms[t->symc].name   = strdup(name);
+        t->syms[t->symc++].addr = (c16_word) l;
+    }
+    fclose(in);
+    qsort(t->syms,t->symc,sizeof(c16_sym),sym_cmp);
+    index_symbols(t);
+    return true;
+}
+
+// Frees the symbols and resets the table to empty.
+void free_symbols(c16_symtab *t){
+    size_t n;
+    for (n = 0;n < t->symc;n++){
+        free(t->syms[n].name);
+    }
+    free(t->syms);
+    free(t->by_name);
+    t->syms    = NULL;
+    t->by_name = NULL;
+    t->symc    = 0;
+    memset(t->by_addr,0,sizeof(t->by_addr));
+}
+
+// Looks up the address of a label by name.
+// return: false if the label does not exist.
+bool sym_lookup(const c16_symtab *t,const char *s,c16_word *addr){
+    size_t   h;
+    uint32_t n;
+    if (!t->by_name){
+        return false;
+    }
+    for (h = sym_hash(s) & t->hash_mask;
+         (n = t->by_name[h]) != SYM_NONE;
+         h = (h + 1) & t->hash_mask){
+        if (!strcmp(t->syms[n - 1].name,s)){
+            *addr = t->syms[n - 1].addr;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Formats the address as `label+off` or `label` into a static buffer.
+// return: NULL if no label precedes the address.
+const char *symstr(c16_word a){
+    static char    b[80];
+    const c16_sym *s = sym_at(&symtab,a);
+    if (!s){
+        return NULL;
+    }
+    if (s->addr == a){
+        return s->name;
+    }
+    snprintf(b,sizeof(b),"%s+0x%x",s->name,a - s->addr);
+    return b;
+}
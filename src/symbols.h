@@ -0,0 +1,79 @@
+/* symbols.h --- label maps for the 16candles debugger.
+   Copyright (c) 2014 Joe Jevnik
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 2 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 51
+   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA. */
+
+#ifndef C16_DEBUG_SYMBOLS_H
+#define C16_DEBUG_SYMBOLS_H
+
+#include "../16common/common/arch.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+// The number of addressable bytes in the machine.
+#define C16_ADDR_SPACE 0x10000
+
+// The suffix appended to the binary's name to find its symbol map.
+#define C16_SYM_SUFFIX ".sym"
+
+// The value in the lookup tables for no label; entries store index + 1 so
+// that a zeroed table is empty.
+#define SYM_NONE 0
+
+// A single label from the symbol map.
+typedef struct{
+    char     *name; // The label name, eg: loop.
+    c16_word  addr; // The address the label marks.
+}c16_sym;
+
+// A loaded symbol map.
+typedef struct{
+    c16_sym  *syms;                    // The labels, sorted by address.
+    size_t    symc;                    // The number of labels.
+    uint32_t  by_addr[C16_ADDR_SPACE]; // Label at or before addr, plus one.
+    uint32_t *by_name;                 // Open addressed hash of label names.
+    size_t    hash_mask;               // The size of by_name minus one.
+}c16_symtab;
+
+// The symbols for the binary being debugged.
+extern c16_symtab symtab;
+
+// Loads the symbol map file into the table, replacing what was there.
+// Each line of the file is `ADDR LABEL`, blank lines and lines starting with
+// '#' are ignored.
+// return: false if the file could not be read or is malformed.
+bool load_symbols(c16_symtab*,const char*);
+
+// Frees the symbols and resets the table to empty.
+void free_symbols(c16_symtab*);
+
+// Looks up the address of a label by name.
+// return: false if the label does not exist.
+bool sym_lookup(const c16_symtab*,const char*,c16_word*);
+
+// Returns the label at or before the given address, or NULL if there is none.
+static inline const c16_sym *sym_at(const c16_symtab *t,c16_word a){
+    uint32_t n = t->by_addr[a];
+    return (n == SYM_NONE) ? NULL : &t->syms[n - 1];
+}
+
+// Formats the address as `label+off` or `label` into a static buffer.
+// return: NULL if no label precedes the address.
+const char *symstr(c16_word);
+
+#endif
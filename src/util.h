@@ -0,0 +1,46 @@
+/* util.h --- hashing and timing shared by the debugger's features.
+   Copyright (c) 2014 Joe Jevnik
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 2 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 51
+   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA. */
+
+#ifndef C16_DEBUG_UTIL_H
+#define C16_DEBUG_UTIL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+// The start of an FNV-1a hash, and the prime it is multiplied by.
+#define FNV_BASIS 0xcbf29ce484222325
+#define FNV_PRIME 0x100000001b3
+
+// Adds len bytes to an FNV-1a hash.
+static inline uint64_t fnv(uint64_t h,const void *p,size_t len){
+    const uint8_t *b = p;
+    size_t         n;
+    for (n = 0;n < len;n++){
+        h = (h ^ b[n]) * FNV_PRIME;
+    }
+    return h;
+}
+
+// Returns the monotonic time in nanoseconds.
+static inline uint64_t now_ns(void){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC,&t);
+    return (uint64_t) t.tv_sec * 1000000000 + t.tv_nsec;
+}
+
+#endif
@@ -0,0 +1,136 @@
+/* verify.c --- lockstep checking against the reference 16machine processor.
+   Copyright (c) 2014 Joe Jevnik
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 2 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 51
+   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA. */
+
+#include "verify.h"
+#include "debug.h"
+#include "reference.h"
+
+// Whether every tick is checked against the reference.
+bool verifying = false;
+
+// The value a tick gives when the machine caused a SIGSEGV.
+#define TICK_FAULT 2
+
+// The memory of the reference, which reference_init() hands to it.
+static c16_mem  ref_mem;
+static c16_vmem ref_vmem;
+
+// The memory is compared every verify_every ticks.
+static unsigned verify_every;
+static unsigned verify_count;
+
+// Starts checking against a second machine that runs 16machine's processor
+// loop, comparing the registers every tick and the memory every n ticks.
+// return: false if the second machine could not be mapped.
+bool init_verify(unsigned n){
+    if (!init_vmem(&ref_mem,&ref_vmem,MEM_ANON,NULL,false)
+        || !reference_init(&ref_mem)){
+        return false;
+    }
+    verify_every = (n) ? n : 1;
+    verifying    = true;
+    verify_sync();
+    return true;
+}
+
+// Copies the debugger's machine into the reference, after a restart.
+void verify_sync(void){
+    reference_load(&regfile);
+    memcpy(ref_mem.mem,sysmem.mem,C16_ADDR_SPACE);
+    memcpy(ref_mem.inputv,sysmem.inputv,256);
+    *ref_mem.inputc = *sysmem.inputc;
+    *ref_mem.inputb = *sysmem.inputb;
+    verify_count    = 0;
+}
+
+// Makes a byte visible to the reference as well, used by push_input().
+void verify_push(c16_halfword c){
+    reference_push(c);
+}
+
+// Prints the registers of both machines side by side, marking differences.
+static void print_divergence(const char *why,const c16_regfile *ref){
+    static const char *names[] = { "ipt","spt","ac1","ac2","tst","inp",
+                                   "r0","r1","r2","r3","r4","r5","r6","r7",
+                                   "r8","r9" };
+    const c16_word *d = (const c16_word*) &regfile;
+    const c16_word *r = (const c16_word*) ref;
+    size_t          n;
+    printf("verify: diverged from the reference at tick %llu: %s\n"
+           "       16cdb   reference\n",(unsigned long long) ticks,why);
+    for (n = 0;n < sizeof(c16_regfile) / sizeof(c16_word);n++){
+        printf("%s %-3s 0x%04x  0x%04x\n",(d[n] != r[n]) ? "*" : " ",
+               names[n],d[n],r[n]);
+    }
+    for (n = 0;n < C16_ADDR_SPACE;n++){
+        if (sysmem.mem[n] != ref_mem.mem[n]){
+            printf("* mem[0x%04zx] 0x%02x  0x%02x\n",n,sysmem.mem[n],
+                   ref_mem.mem[n]);
+            break;
+        }
+    }
+    puts("verify: stopped checking");
+}
+
+// Runs a tick on the debugger's machine then on the reference and compares
+// them. At the first divergence both states are printed and checking stops.
+// When the debugger's machine faults the reference is still stepped, so the
+// two stay in step, and the fault is passed on to the caller afterwards.
+// return: -1 if the debugger's machine read `term`, 1 if they diverged.
+int verify_tick(void){
+    jmp_buf      saved;
+    c16_regfile  ref;
+    volatile int d,r;
+    const char  *why = NULL;
+    memcpy(saved,jump,sizeof(jmp_buf));
+    if (sigsetjmp(jump,1) == 0){
+        d = proc_tick();
+    }else{
+        d = TICK_FAULT;
+    }
+    if (sigsetjmp(jump,1) == 0){
+        ticking = 1;
+        r = reference_tick();
+        ticking = 0;
+    }else{
+        reference_recover();
+        r = TICK_FAULT;
+    }
+    memcpy(jump,saved,sizeof(jmp_buf));
+    reference_save(&ref);
+    if (d != r){
+        why = (d == TICK_FAULT) ? "only 16cdb crashed"
+            : (r == TICK_FAULT) ? "only the reference crashed"
+            : (d) ? "only 16cdb read `term`"
+            : "only the reference read `term`";
+    }else if (memcmp(&regfile,&ref,sizeof(c16_regfile))){
+        why = "the registers differ";
+    }else if (++verify_count >= verify_every){
+        verify_count = 0;
+        if (memcmp(sysmem.mem,ref_mem.mem,C16_ADDR_SPACE)){
+            why = "the memory differs";
+        }
+    }
+    if (why){
+        print_divergence(why,&ref);
+        verifying = false;
+    }
+    if (d == TICK_FAULT){
+        siglongjmp(jump,1);
+    }
+    return (why) ? 1 : d;
+}
@@ -0,0 +1,58 @@
+/* verify.h --- lockstep checking against the reference 16machine processor.
+   Copyright (c) 2014 Joe Jevnik
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 2 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 51
+   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA. */
+
+#ifndef C16_DEBUG_VERIFY_H
+#define C16_DEBUG_VERIFY_H
+
+#include "../16common/common/arch.h"
+#include "../16machine/machine/memory.h"
+#include "../16machine/machine/register.h"
+#include "regfile.h"
+#include "vmem.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Whether every tick is checked against the reference.
+extern bool verifying;
+
+// Starts checking against a second machine that runs 16machine's processor
+// loop, comparing the registers every tick and the memory every n ticks.
+// The second machine starts as a copy of the first, so this is called after
+// the binary is loaded.
+// return: false if the second machine could not be mapped.
+bool init_verify(unsigned);
+
+// Copies the debugger's machine into the reference, after a restart.
+void verify_sync(void);
+
+// Makes a byte visible to the reference as well, used by push_input().
+void verify_push(c16_halfword);
+
+// Runs a tick on the debugger's machine then on the reference and compares
+// them. At the first divergence both states are printed and checking stops.
+// return: -1 if the debugger's machine read `term`, 1 if they diverged.
+int verify_tick(void);
+
+// Runs a tick, checked against the reference when verifying.
+// return: -1 if an exit opcode was encountered, 1 if the machines diverged.
+static inline int vm_tick(void){
+    int proc_tick(void);
+    return (verifying) ? verify_tick() : proc_tick();
+}
+
+#endif
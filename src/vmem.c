@@ -0,0 +1,150 @@
+/* vmem.c --- backing memory for the 16candles debugger's vm.
+   Copyright (c) 2014 Joe Jevnik
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 2 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 51
+   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA. */
+
+#define _GNU_SOURCE
+#include "vmem.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+// The mapping behind sysmem.
+c16_vmem sysvmem = { .fd = -1 };
+
+// The names of the modes, indexed by c16_memmode.
+const char* const memmode_strs[] = { "file","anon" };
+
+// Parses a memory mode name.
+// return: false if the name is not a mode.
+bool parse_memmode(const char *s,c16_memmode *mode){
+    int n;
+    for (n = MEM_FILE;n <= MEM_ANON;n++){
+        if (!strcmp(s,memmode_strs[n])){
+            *mode = (c16_memmode) n;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Opens an anonymous memory object that is private to this process.
+// return: the file descriptor, or -1.
+static int open_anon(void){
+#ifdef MFD_CLOEXEC
+    return memfd_create("16cdb",MFD_CLOEXEC);
+#else
+    char name[32];
+    int  fd;
+    snprintf(name,sizeof(name),"/16cdb-%d",(int) getpid());
+    fd = shm_open(name,O_RDWR | O_CREAT | O_EXCL,0600);
+    shm_unlink(name);
+    return fd;
+#endif
+}
+
+// Maps len bytes of the object at off over the reservation at addr.
+// return: false if the mapping failed.
+static bool map_at(void *addr,size_t len,int fd,off_t off,int flags){
+    return mmap(addr,len,PROT_READ | PROT_WRITE,MAP_SHARED | MAP_FIXED | flags,
+                fd,off) != MAP_FAILED;
+}
+
+// Maps the machine's memory. The file is only used by MEM_FILE, which keeps
+// 16machine's layout of it; anon memory is pre-faulted, and locked into ram
+// if lock is true.
+// The reservation is laid out as:
+//   guard | memory (64K) | mirror of the first page | guard | input page
+// For anon memory the object behind it is the memory followed by the input
+// page. For a file, init_mem() creates and maps it as 16machine does, so
+// tools that map the file from outside still find everything where they
+// expect; the memory at the start of the file is mapped again into the
+// reservation and the input stays where init_mem() put it.
+// return: false if the memory could not be mapped.
+bool init_vmem(c16_mem *m,c16_vmem *v,c16_memmode mode,char *fl,bool lock){
+    size_t        pg    = (size_t) sysconf(_SC_PAGESIZE);
+    int           flags = 0;
+    c16_halfword *p,*in;
+    v->mode     = mode;
+    v->len      = pg + C16_ADDR_SPACE + pg + pg + pg;
+    v->file_mem = NULL;
+    if (mode == MEM_FILE){
+        init_mem(m,fl);
+        v->file_mem = m->mem;
+        v->fd       = open(fl,O_RDWR);
+    }else{
+        v->fd = open_anon();
+#ifdef MAP_POPULATE
+        flags = MAP_POPULATE;
+#endif
+    }
+    if (v->fd == -1
+        || (mode != MEM_FILE && ftruncate(v->fd,C16_ADDR_SPACE + pg))){
+        perror("16cdb: memory");
+        goto fail;
+    }
+    v->base = mmap(NULL,v->len,PROT_NONE,MAP_PRIVATE | MAP_ANONYMOUS,-1,0);
+    if (v->base == MAP_FAILED){
+        perror("16cdb: mmap");
+        goto fail;
+    }
+    p  = (c16_halfword*) v->base + pg;
+    in = p + C16_ADDR_SPACE + 2 * pg;
+    if (!map_at(p,C16_ADDR_SPACE,v->fd,0,flags)
+        || !map_at(p + C16_ADDR_SPACE,pg,v->fd,0,flags)
+        || (mode != MEM_FILE && !map_at(in,pg,v->fd,C16_ADDR_SPACE,flags))){
+        perror("16cdb: mmap");
+        munmap(v->base,v->len);
+        goto fail;
+    }
+    if (lock && mode != MEM_FILE
+        && (mlock(p,C16_ADDR_SPACE + pg) || mlock(in,pg))){
+        perror("warning: mlock");
+    }
+    m->mem = p;
+    if (mode != MEM_FILE){
+        m->inputv = in;
+        m->inputc = (void*) &in[256];
+        m->inputb = (void*) &in[256 + sizeof(*m->inputc)];
+    }
+    return true;
+fail:
+    if (v->fd != -1){
+        close(v->fd);
+        v->fd = -1;
+    }
+    if (v->file_mem){
+        m->mem = v->file_mem;
+        free_mem(m);
+        v->file_mem = NULL;
+    }
+    return false;
+}
+
+// Unmaps the machine's memory.
+void free_vmem(c16_mem *m,c16_vmem *v){
+    munmap(v->base,v->len);
+    close(v->fd);
+    v->fd = -1;
+    if (v->file_mem){
+        m->mem = v->file_mem;
+        free_mem(m);
+        v->file_mem = NULL;
+    }else{
+        m->mem = NULL;
+    }
+}
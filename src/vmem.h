@@ -0,0 +1,66 @@
+/* vmem.h --- backing memory for the 16candles debugger's vm.
+   Copyright (c) 2014 Joe Jevnik
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation; either version 2 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along with
+   this program; if not, write to the Free Software Foundation, Inc., 51
+   Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA. */
+
+#ifndef C16_DEBUG_VMEM_H
+#define C16_DEBUG_VMEM_H
+
+#include "../16common/common/arch.h"
+#include "../16machine/machine/memory.h"
+#include "symbols.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+
+// How the machine's memory is backed.
+typedef enum{
+    MEM_FILE, // 16machine's mmapped file, that other processes can read.
+    MEM_ANON, // Anonymous memory private to this process.
+}c16_memmode;
+
+// The mapping behind a c16_mem.
+// The 64K of memory is mapped with the first page mapped again right after
+// it, so a word or instruction that wraps past 0xffff reads and writes the
+// bottom of memory without any bounds checks. Past the mirror, and before
+// the memory, are guard pages that still fault.
+typedef struct{
+    c16_memmode   mode;     // How the memory is backed.
+    void         *base;     // The start of the whole reservation.
+    size_t        len;      // The length of the whole reservation.
+    int           fd;       // The memory object that is mapped.
+    c16_halfword *file_mem; // The memory as init_mem() mapped it.
+}c16_vmem;
+
+// The mapping behind sysmem.
+extern c16_vmem sysvmem;
+
+// The names of the modes, indexed by c16_memmode.
+extern const char* const memmode_strs[];
+
+// Parses a memory mode name.
+// return: false if the name is not a mode.
+bool parse_memmode(const char*,c16_memmode*);
+
+// Maps the machine's memory. The file is only used by MEM_FILE, which keeps
+// 16machine's layout of it; anon memory is pre-faulted, and locked into ram
+// if lock is true.
+// return: false if the memory could not be mapped.
+bool init_vmem(c16_mem*,c16_vmem*,c16_memmode,char*,bool);
+
+// Unmaps the machine's memory.
+void free_vmem(c16_mem*,c16_vmem*);
+
+#endif